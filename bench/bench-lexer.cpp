@@ -0,0 +1,123 @@
+/// \file
+/// \brief Throughput of the table-driven lexer against stream extraction.
+///
+/// Generates a synthetic C-like file and tokenizes it three ways: with
+/// `operator>>` into std::string, with a hand-written get()/peek() lexer,
+/// and with `dfa_lexer` over the mapped buffer. Prints MB/s for each.
+///
+/// Usage: bench-lexer [megabytes] [path]
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+
+enum : std::uint16_t
+{
+    IDENT = 1,
+    NUMBER,
+    STRING,
+    OP
+};
+
+static constexpr auto spec = []
+{
+    mms::lexer_spec<> s;
+    s.skip(mms::charset::space())
+        .line_comment("//")
+        .block_comment("/*", "*/")
+        .identifier(IDENT)
+        .number(NUMBER)
+        .quoted(STRING, '"');
+    for (std::string_view op : {"+", "-", "*", "/", "=", "==", "+=", "(", ")", "{", "}", ";", ",", "<", ">"})
+        s.literal(OP, op);
+    return s;
+}();
+
+static constexpr auto table = mms::make_dfa(spec);
+
+static void generate(const fs::path &path, std::size_t bytes)
+{
+    static const char *const lines[] = {
+        "int compute_total(int count, int *values) {\n",
+        "    int total = 0; // running sum\n",
+        "    for (int i = 0; i < count; i += 1) { total = total + values[i] * 3; }\n",
+        "    /* clamp the result */ if (total > 100000) total = 100000;\n",
+        "    printf(\"total=%d\\n\", total);\n",
+        "    return total;\n",
+        "}\n\n",
+    };
+    std::ofstream out(path, std::ios::binary);
+    std::size_t written = 0;
+    for (std::size_t i = 0; written < bytes; ++i)
+    {
+        const char *line = lines[i % (sizeof(lines) / sizeof(lines[0]))];
+        out << line;
+        written += std::char_traits<char>::length(line);
+    }
+}
+
+template <typename F>
+static void run(const char *name, std::size_t bytes, F &&body)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t tokens = body();
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    std::printf("%-22s %10zu tokens %9.1f MB/s\n", name, tokens,
+                static_cast<double>(bytes) / (1024.0 * 1024.0) / took.count());
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+    fs::path path = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "mms-bench-lexer.c";
+    generate(path, mb * 1024 * 1024);
+    std::size_t bytes = fs::file_size(path);
+
+    run("operator>> (words)", bytes, [&]
+        {
+            mms::source s(path.c_str());
+            std::string word;
+            std::size_t n = 0;
+            while (s >> word)
+                ++n;
+            return n; });
+
+    run("get()/peek() lexer", bytes, [&]
+        {
+            mms::source s(path.c_str());
+            std::size_t n = 0;
+            int c;
+            while ((c = s.get()) != EOF)
+            {
+                if (std::isspace(c))
+                    continue;
+                if (std::isalnum(c) || c == '_')
+                    while (std::isalnum(s.peek()) || s.peek() == '_')
+                        s.get();
+                ++n;
+            }
+            return n; });
+
+    run("dfa_lexer", bytes, [&]
+        {
+            mms::source s(path.c_str());
+            mms::dfa_lexer lx(table.view(), s);
+            std::size_t n = 0;
+            while (lx.next().id != mms::lex::end)
+                ++n;
+            return n; });
+
+    fs::remove(path);
+    return 0;
+}
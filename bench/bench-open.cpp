@@ -0,0 +1,86 @@
+/// \file
+/// \brief Files per second: one-at-a-time `source` construction against `batch_opener`.
+///
+/// Creates many small files in a temporary directory and opens them all,
+/// first sequentially, then through `batch_opener` with io_uring (when the
+/// kernel allows it) and with the worker-thread fallback.
+///
+/// Usage: bench-open [files] [directory]
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+
+template <typename F>
+static void run(const char *name, std::size_t files, F &&body)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t bytes = body();
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %10.0f files/s  (%zu bytes read)\n", name,
+                static_cast<double>(files) / took.count(), bytes);
+}
+
+// Touch the first byte so every variant pays for the page fault
+static std::size_t touch(mms::source &s)
+{
+    return s.peek() != EOF ? 1 : 0;
+}
+
+static std::size_t drain(mms::batch_opener &opener)
+{
+    std::size_t bytes = 0;
+    while (auto r = opener.next())
+        if (r->src)
+            bytes += touch(*r->src);
+    return bytes;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    fs::path dir = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "mms-bench-open";
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        fs::path p = dir / ("f" + std::to_string(i) + ".inc");
+        std::ofstream(p, std::ios::binary) << "; include " << i << "\n    ld a, " << i % 256 << "\n";
+        paths.push_back(p.string());
+    }
+
+    run("source (sequential)", count, [&]
+        {
+            std::size_t bytes = 0;
+            for (const auto &p : paths)
+            {
+                mms::source s(p.c_str());
+                bytes += touch(s);
+            }
+            return bytes; });
+
+    mms::batch_opener uring(paths);
+    run(uring.uses_io_uring() ? "batch_opener (io_uring)" : "batch_opener (threads)", count, [&]
+        { return drain(uring); });
+
+    mms::batch_options opts;
+    opts.use_io_uring = false;
+    mms::batch_opener pool(paths, opts);
+    run("batch_opener (threads)", count, [&]
+        { return drain(pool); });
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/// \file
+/// \brief Throughput of the record scanner against stream extraction.
+///
+/// Generates a numeric table and reads it back: blank-separated with
+/// `read_int` (the parser behind `operator>>`), blank-separated with `record_scanner` and
+/// comma-separated with `record_scanner`, converting every field. Prints
+/// MB/s for each.
+///
+/// Usage: bench-records [megabytes] [path]
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+
+static void generate(const fs::path &path, std::size_t bytes, char separator)
+{
+    std::ofstream out(path, std::ios::binary);
+    std::size_t written = 0;
+    for (unsigned row = 0; written < bytes; ++row)
+    {
+        std::string line;
+        for (unsigned col = 0; col < 8; ++col)
+        {
+            if (col)
+                line += separator;
+            line += std::to_string((row * 7919u + col * 104729u) % 1000000u);
+        }
+        line += '\n';
+        out << line;
+        written += line.size();
+    }
+}
+
+template <typename F>
+static void run(const char *name, const fs::path &path, F &&body)
+{
+    std::size_t bytes = fs::file_size(path);
+    auto start = std::chrono::steady_clock::now();
+    long long sum = body();
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    std::printf("%-26s sum %14lld %9.1f MB/s\n", name, sum,
+                static_cast<double>(bytes) / (1024.0 * 1024.0) / took.count());
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    fs::path base = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "mms-bench-records";
+    fs::path blanks = base.string() + ".txt", commas = base.string() + ".csv";
+    generate(blanks, mb * 1024 * 1024, ' ');
+    generate(commas, mb * 1024 * 1024, ',');
+
+    run("read_int (blanks)", blanks, [&]
+        {
+            mms::source s(blanks.c_str());
+            long long sum = 0;
+            while (auto value = mms::read_int(s))
+                sum += *value;
+            return sum; });
+
+    run("record_scanner (blanks)", blanks, [&]
+        {
+            mms::source s(blanks.c_str());
+            mms::record_options opts;
+            opts.whitespace = true;
+            mms::record_scanner r(s, opts);
+            long long sum = 0;
+            while (r.next())
+                for (std::size_t i = 0; i < r.size(); ++i)
+                    sum += *r.to<int>(i);
+            return sum; });
+
+    run("record_scanner (commas)", commas, [&]
+        {
+            mms::source s(commas.c_str());
+            mms::record_scanner r(s);
+            long long sum = 0;
+            while (r.next())
+                for (std::size_t i = 0; i < r.size(); ++i)
+                    sum += *r.to<int>(i);
+            return sum; });
+
+    fs::remove(blanks);
+    fs::remove(commas);
+    return 0;
+}
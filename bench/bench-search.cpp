@@ -0,0 +1,97 @@
+/// \file
+/// \brief Throughput of substring and keyword search against a get() loop.
+///
+/// Generates a synthetic assembly-like file with occasional directives and
+/// finds them three ways: by matching byte by byte through `get()`, with
+/// `source::find_all` for a single needle, and with a `pattern_set` of
+/// several directives. Prints MB/s for each.
+///
+/// Usage: bench-search [megabytes] [path]
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+
+static void generate(const fs::path &path, std::size_t bytes)
+{
+    static const char *const lines[] = {
+        "        ld      a,(hl)          ; fetch the next byte\n",
+        "        inc     hl\n",
+        "        cp      0x20\n",
+        "        jr      nz,skip_blank   ; not a blank\n",
+        "        djnz    loop\n",
+        "        ret\n",
+    };
+    std::ofstream out(path, std::ios::binary);
+    std::size_t written = 0;
+    for (std::size_t i = 0; written < bytes; ++i)
+    {
+        const char *line = i % 500 == 0   ? "        .section code\n"
+                           : i % 97 == 0 ? "#pragma once\n"
+                                         : lines[i % (sizeof(lines) / sizeof(lines[0]))];
+        out << line;
+        written += std::char_traits<char>::length(line);
+    }
+}
+
+template <typename F>
+static void run(const char *name, std::size_t bytes, F &&body)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t found = body();
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    std::printf("%-22s %10zu matches %9.1f MB/s\n", name, found,
+                static_cast<double>(bytes) / (1024.0 * 1024.0) / took.count());
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    fs::path path = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "mms-bench-search.asm";
+    generate(path, mb * 1024 * 1024);
+    std::size_t bytes = fs::file_size(path);
+    constexpr std::string_view needle = "#pragma";
+
+    run("get() loop", bytes, [&]
+        {
+            mms::source s(path.c_str());
+            std::size_t n = 0, matched = 0;
+            int c;
+            while ((c = s.get()) != EOF)
+            {
+                matched = c == needle[matched] ? matched + 1 : c == needle[0];
+                if (matched == needle.size())
+                {
+                    ++n;
+                    matched = 0;
+                }
+            }
+            return n; });
+
+    run("find_all (needle)", bytes, [&]
+        {
+            mms::source s(path.c_str());
+            s.index(); // resolve line/column without timing the index build twice
+            return s.find_all(needle).size(); });
+
+    run("find_all (keywords)", bytes, [&]
+        {
+            mms::source s(path.c_str());
+            mms::pattern_set directives{"#pragma", ".section", ".org", "#include"};
+            s.index();
+            return s.find_all(directives).size(); });
+
+    fs::remove(path);
+    return 0;
+}
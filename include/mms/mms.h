@@ -11,21 +11,93 @@
 #include <unistd.h>
 #include <sys/mman.h>
 
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
 #include <set>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <map>
 #include <cstring>
 #include <stdexcept>
 #include <ios>
 #include <streambuf>
 #include <istream>
-#include <codecvt>
-#include <locale>
 #include <iostream>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace mms
 {
+    /// \brief Errors reported by the non-throwing API besides system errors.
+    enum class errc
+    {
+        invalid_integer = 1, ///< No digits where an integer was expected
+        unexpected_eof,      ///< End of input where a character was expected
+        invalid_number       ///< A field is not entirely a number of the requested type
+    };
+
+    /// \return Category of `mms::errc` error codes
+    const std::error_category &error_category() noexcept;
+
+    /// \return Error code for \p e in `error_category()`
+    std::error_code make_error_code(errc e) noexcept;
+
+    /// \brief Value or error code, returned by the non-throwing API.
+    ///
+    /// A minimal stand-in for C++23 `std::expected<T, std::error_code>`.
+    /// As with `std::optional`, dereferencing a failed result is undefined
+    /// rather than throwing, so it is usable in builds without exceptions.
+    template <typename T>
+    class result
+    {
+    public:
+        result(T value) noexcept(std::is_nothrow_move_constructible_v<T>) : value_(std::move(value)) {}
+        result(std::error_code error) noexcept : error_(error) {}
+
+        bool has_value() const noexcept { return value_.has_value(); }
+        explicit operator bool() const noexcept { return value_.has_value(); }
+
+        T &operator*() & noexcept { return *value_; }
+        const T &operator*() const & noexcept { return *value_; }
+        T &&operator*() && noexcept { return std::move(*value_); }
+        T *operator->() noexcept { return &*value_; }
+        const T *operator->() const noexcept { return &*value_; }
+
+        /// \return The error (empty if the result holds a value)
+        std::error_code error() const noexcept { return error_; }
+
+        template <typename U>
+        T value_or(U &&fallback) const &
+        {
+            return value_ ? *value_ : static_cast<T>(std::forward<U>(fallback));
+        }
+
+    private:
+        std::optional<T> value_;
+        std::error_code error_;
+    };
+
     /// \brief Represents a bookmarked position in the input stream.
     ///
     /// Stores the file position, line number, and column number for later retrieval.
@@ -35,7 +107,8 @@ namespace mms
         /// \param pos    Absolute byte position in the file
         /// \param line   Line number at the bookmark
         /// \param column Column number at the bookmark
-        bookmark(std::size_t pos, int line, int column);
+        /// \param generation Version of the text the bookmark refers to (see `source::reload`)
+        bookmark(std::size_t pos, int line, int column, std::uint32_t generation = 0);
 
         /// \return Stored byte position
         std::size_t position() const;
@@ -46,20 +119,59 @@ namespace mms
         /// \return Stored column number
         int column() const;
 
+        /// \return Version of the text the bookmark was taken in
+        std::uint32_t generation() const;
+
     private:
         std::size_t pos_;
         int line_;
         int column_;
+        std::uint32_t generation_;
+    };
+
+    /// \brief Line terminator convention used to count lines and columns.
+    enum class line_ending
+    {
+        lf,    ///< '\n' ends a line (Unix)
+        crlf,  ///< '\n' ends a line and a '\r' before it takes no column (Windows)
+        cr,    ///< '\r' ends a line (classic Mac OS)
+        detect ///< Choose one of the above from the first block of the input
+    };
+
+    /// \brief Pick the predominant line ending in the first block of a buffer.
+    ///
+    /// Inputs without any line break are reported as `line_ending::lf`.
+    line_ending detect_line_ending(const char *data, std::size_t size);
+
+    /// \brief Unit in which columns are counted.
+    enum class column_unit
+    {
+        bytes,      ///< One column per byte (the default)
+        code_points ///< One column per UTF-8 code point (continuation bytes take none)
     };
 
     /// \brief Tracks line and column numbers while reading a character stream.
     ///
     /// Supports updating positions on character consumption, putback,
     /// and allows bookmarks to speed up random seeks.
+    ///
+    /// Line breaks follow the configured `line_ending`. In CRLF mode a '\r'
+    /// directly before '\n' does not advance the column; when no buffer is
+    /// attached the tracker cannot look ahead and treats every '\r' that way.
     class postrack
     {
     public:
-        postrack();
+        /// \param endings Line terminator convention (`detect` behaves as
+        ///                `lf` until a buffer is attached)
+        explicit postrack(line_ending endings = line_ending::lf);
+
+        /// \brief Give the tracker access to the text being read.
+        ///
+        /// Enables exact CRLF handling and resolves `line_ending::detect`.
+        void attach(const char *data, std::size_t size);
+
+        /// \return Line terminator convention in effect
+        line_ending endings() const;
 
         /// \brief Update tracker for a consumed character.
         void update_position(int ch);
@@ -76,6 +188,9 @@ namespace mms
         /// \brief Set position to bookmark.
         void set_position(const bookmark &b);
 
+        /// \return True if a bookmark was added at byte position \p pos
+        bool has_bookmark(std::size_t pos) const;
+
         /// \return Current line number
         int line() const;
 
@@ -88,14 +203,100 @@ namespace mms
         /// \return Current position.
         std::size_t position() const;
 
+        /// \brief Count columns in \p unit from now on.
+        ///
+        /// In `code_points` mode a checkpoint (byte offset and column) is kept
+        /// every \p checkpoint_interval bytes of a line, recorded while
+        /// reading and while resolving columns, so resolving a column scans
+        /// at most one interval however long the line is.
+        void set_column_unit(column_unit unit, std::size_t checkpoint_interval = 4096);
+
+        /// \return Unit columns are counted in
+        column_unit columns() const;
+
+        /// \return Bytes between column checkpoints
+        std::size_t checkpoint_interval() const;
+
+        /// \return Column of \p pos on the line starting at byte \p line_start
+        int column_from(std::size_t line_start, std::size_t pos) const;
+
     private:
+        /// \return True if the '\r' at \p pos takes no column
+        bool is_zero_width_cr(std::size_t pos) const;
+
+        /// \brief Column of \p pos computed from the recorded line breaks.
+        int column_at(std::size_t pos) const;
+
+        /// \brief Schedule the next checkpoint of the line starting at \p line_start.
+        void sync_checkpoint(std::size_t line_start);
+
         int line_;
         int column_;
         std::size_t current_pos_;
         std::set<std::size_t> newline_positions_;
         std::map<std::size_t, std::pair<int, int>> bookmarks_;
+        line_ending endings_;
+        char break_char_;
+        const char *data_;
+        std::size_t size_;
+        column_unit unit_;
+        std::size_t interval_;
+        /// Position at which the next checkpoint of the current line is due
+        std::size_t next_checkpoint_;
+        /// Code point column at byte offsets within long lines
+        mutable std::map<std::size_t, int> checkpoints_;
+    };
+
+    /// \brief 128-bit content digest.
+    struct digest
+    {
+        std::uint64_t low = 0;
+        std::uint64_t high = 0;
+
+        friend bool operator==(const digest &a, const digest &b) = default;
+
+        /// \return 32 lowercase hex digits, `high` first
+        std::string hex() const;
+    };
+
+    /// \brief Fast non-cryptographic 128-bit hash of a byte stream (XXH3-style).
+    ///
+    /// Input is consumed in 64-byte stripes of eight 64-bit lanes, each lane
+    /// accumulating the product of the halves of its data mixed with a key
+    /// (two lanes per SSE2 multiply); the accumulators are scrambled after
+    /// every kilobyte. The digest depends only on the bytes, not on how they
+    /// are split between `update()` calls.
+    class content_hasher
+    {
+    public:
+        content_hasher();
+
+        /// \brief Hash \p size more bytes.
+        void update(const char *data, std::size_t size);
+
+        /// \return Digest of all bytes so far (the hasher can keep going)
+        digest finish() const;
+
+        /// \return Digest of [data, data + size)
+        static digest hash(const char *data, std::size_t size);
+
+    private:
+        std::uint64_t acc_[8];
+        unsigned stripe_;          ///< Stripes accumulated since the last scramble
+        char buffer_[64];
+        std::size_t buffered_;
+        std::uint64_t length_;
     };
 
+    /// \brief Digest each \p block bytes of [data, data + size) separately.
+    ///
+    /// Comparing the lists of two versions of a file shows which regions changed.
+    /// Blocks are aligned to the start of the text, or to its end if \p from_end
+    /// is set, in which case the list runs from the last block backwards.
+    /// \return The low 64 bits of each block's digest
+    std::vector<std::uint64_t> block_digests(const char *data, std::size_t size, std::size_t block = 4096,
+                                             bool from_end = false);
+
     /// \brief RAII wrapper for POSIX memory-mapped file access.
     ///
     /// Opens a file, maps it into memory for read-only access,
@@ -105,8 +306,26 @@ namespace mms
     public:
         /// \param filename Path to the file to memory-map
         explicit file(const char *filename);
+
+        /// \brief Map an already opened descriptor, taking ownership of it.
+        /// \param fd   Descriptor opened for reading
+        /// \param size Size of the file in bytes
+        /// \param path Path the descriptor was opened from, if known
+        file(int fd, std::size_t size, std::string path = {});
         ~file();
 
+        /// \brief Open and map a file without throwing.
+        ///
+        /// A missing file costs a single failed `open` call.
+        /// \return The file, the `errno` of the failed call as a system error,
+        ///         or `std::errc::not_enough_memory` if an allocation failed
+        static result<file> open(const char *filename) noexcept;
+
+        file(file &&other) noexcept;
+        file &operator=(file &&other) noexcept;
+        file(const file &) = delete;
+        file &operator=(const file &) = delete;
+
         /// \return Pointer to the mapped file data
         const char *data() const;
 
@@ -116,10 +335,677 @@ namespace mms
         /// \return True if mapping succeeded
         bool is_open() const;
 
+        /// \return Path the file was opened from (empty if unknown)
+        const std::string &path() const;
+
+        /// \return Digest of the mapped bytes, computed on first call and cached
+        digest content_digest() const;
+
     private:
+        friend class source; // fuses the digest with its line index scan
+        friend class bundle; // hands out members of its mapping
+
+        /// \brief Adopt a descriptor that is already mapped.
+        file(int fd, std::size_t size, const char *mapped, std::string path) noexcept;
+
+        /// \brief View \p size bytes at \p data of the mapping of \p owner, keeping it alive.
+        file(std::shared_ptr<const file> owner, const char *data, std::size_t size, std::string path) noexcept;
+
+        /// \brief Map `file_size_` bytes of `file_descriptor_`.
+        void map();
+
         int file_descriptor_;
         std::size_t file_size_;
         const char *mapped_data_;
+        std::string path_;
+        mutable std::optional<digest> digest_;
+        /// Mapping this file is a part of (a bundle member), unmapped by its owner
+        std::shared_ptr<const file> owner_;
+    };
+
+    /// \brief Bounds-checked reader of binary data, for object files and archives.
+    ///
+    /// Reads trivially copyable values straight from the mapping at a moving
+    /// offset; every read checks that it stays inside the data and throws
+    /// `std::out_of_range` otherwise. Integers are loaded in an explicit
+    /// byte order, and tables of integers are byte-swapped 16 bytes at a
+    /// time. Aligned tables in the file's own byte order can be viewed in
+    /// place as `std::span<const T>` without copying.
+    class binary_reader
+    {
+    public:
+        /// \brief Read the bytes of \p f, which must outlive the reader.
+        /// \param order Byte order of `read_int` and `read_ints`
+        explicit binary_reader(const file &f, std::endian order = std::endian::little);
+
+        /// \brief Read [data, data + size).
+        binary_reader(const char *data, std::size_t size, std::endian order = std::endian::little);
+
+        /// \return Byte order of `read_int` and `read_ints`
+        std::endian order() const { return order_; }
+
+        /// \brief Change the byte order, e.g. once a header has been identified.
+        void set_order(std::endian order) { order_ = order; }
+
+        /// \return Start of the data
+        const char *data() const { return data_; }
+
+        /// \return Size of the data in bytes
+        std::size_t size() const { return size_; }
+
+        /// \return Offset of the next read
+        std::size_t position() const { return pos_; }
+
+        /// \return Bytes left after the read position
+        std::size_t remaining() const { return size_ - pos_; }
+
+        /// \brief Move the read position to \p pos (at most `size()`).
+        void seek(std::size_t pos);
+
+        /// \brief Advance the read position by \p n bytes.
+        void skip(std::size_t n);
+
+        /// \return Reader over \p size bytes at \p offset (a section or archive member), in the same byte order
+        binary_reader sub(std::size_t offset, std::size_t size) const;
+
+        /// \brief Read a `T` as laid out in memory, without byte swapping.
+        template <typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "binary_reader: T must be trivially copyable");
+            require(sizeof(T));
+            T value;
+            std::memcpy(&value, data_ + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return value;
+        }
+
+        /// \brief Read a little-endian integer.
+        template <std::integral T>
+        T read_le() { return load<T>(std::endian::little); }
+
+        /// \brief Read a big-endian integer.
+        template <std::integral T>
+        T read_be() { return load<T>(std::endian::big); }
+
+        /// \brief Read an integer in the reader's byte order.
+        template <std::integral T>
+        T read_int() { return load<T>(order_); }
+
+        /// \brief Fill \p out with consecutive integers in the reader's byte order.
+        template <std::integral T>
+        void read_ints(std::span<T> out)
+        {
+            require_array(out.size(), sizeof(T));
+            copy_ints(out.data(), out.size(), sizeof(T));
+        }
+
+        /// \brief Read an unsigned LEB128 number (DWARF, WebAssembly).
+        /// \throws std::invalid_argument if it does not fit in 64 bits
+        std::uint64_t read_uleb128();
+
+        /// \brief Read a signed LEB128 number.
+        /// \throws std::invalid_argument if it does not fit in 64 bits
+        std::int64_t read_sleb128();
+
+        /// \brief Read a NUL-terminated string and skip its terminator.
+        /// \return The string, without the terminator
+        std::string_view read_string();
+
+        /// \brief Read \p n bytes without copying them.
+        std::span<const std::byte> read_bytes(std::size_t n);
+
+        /// \brief View \p count consecutive `T` at the read position in place.
+        ///
+        /// The values are in the file's byte order; use `read_ints` to
+        /// convert a table of foreign-order integers.
+        /// \throws std::invalid_argument if the position is not aligned for `T`
+        template <typename T>
+        std::span<const T> view(std::size_t count)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "binary_reader: T must be trivially copyable");
+            require_array(count, sizeof(T));
+            require_aligned(alignof(T));
+            std::span<const T> table(reinterpret_cast<const T *>(data_ + pos_), count);
+            pos_ += count * sizeof(T);
+            return table;
+        }
+
+    private:
+        /// \brief Throw `std::out_of_range` unless \p n more bytes can be read.
+        void require(std::size_t n) const;
+
+        /// \brief `require` for \p count values of \p width bytes, guarding the product.
+        void require_array(std::size_t count, std::size_t width) const;
+
+        /// \brief Throw `std::invalid_argument` unless the read position is aligned to \p alignment.
+        void require_aligned(std::size_t alignment) const;
+
+        /// \brief Copy \p count integers of \p width bytes to \p out, swapping them if needed.
+        void copy_ints(void *out, std::size_t count, std::size_t width);
+
+        template <std::integral T>
+        T load(std::endian from)
+        {
+            T value = read<T>();
+            if (from == std::endian::native)
+                return value;
+
+            // Reassembled byte by byte; compilers turn this into a single swap
+            using U = std::make_unsigned_t<T>;
+            U in = static_cast<U>(value), out = 0;
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                out = static_cast<U>((out << 8) | (in & 0xFF));
+                in = static_cast<U>(in >> 8);
+            }
+            return static_cast<T>(out);
+        }
+
+        const char *data_;
+        std::size_t size_;
+        std::size_t pos_;
+        std::endian order_;
+    };
+
+    /// \brief Memory-mapped output file, the writing counterpart of `file`.
+    ///
+    /// The file is grown in large extents (preallocated where the file
+    /// system supports it) and mapped writable one extent at a time, so
+    /// output is written straight into the page cache without stream
+    /// buffers. Line and column of the output are tracked with the same
+    /// conventions as `postrack`, for emitting line maps. `close()` trims
+    /// the file to the bytes written.
+    class sink
+    {
+    public:
+        /// \param filename Path of the file to create or truncate
+        /// \param endings  Line terminator convention for line/column tracking
+        /// \param extent   Bytes mapped (and preallocated) at a time
+        explicit sink(const char *filename,
+                      line_ending endings = line_ending::lf,
+                      std::size_t extent = 64 << 20);
+        ~sink();
+
+        sink(const sink &) = delete;
+        sink &operator=(const sink &) = delete;
+
+        /// \brief Writable space for the next \p n bytes.
+        ///
+        /// Nothing counts as written until `commit()`. The span is valid
+        /// until the next call to `reserve()`, a write or `close()`.
+        std::span<char> reserve(std::size_t n);
+
+        /// \brief Mark the first \p n bytes of the last reserved span as written.
+        void commit(std::size_t n);
+
+        /// \brief Append raw bytes.
+        void write(const char *data, std::size_t n);
+
+        /// \brief Append the object representation of \p value (for binary formats).
+        template <typename T>
+            requires std::is_trivially_copyable_v<T>
+        void write_value(const T &value)
+        {
+            std::memcpy(reserve(sizeof(T)).data(), &value, sizeof(T));
+            commit(sizeof(T));
+        }
+
+        /// \brief Append \p value as \p digits upper-case hex digits, zero-filled.
+        void write_hex(std::uint64_t value, int digits);
+
+        /// \brief Append spaces until the output reaches \p column (1-based).
+        void pad_to_column(int column);
+
+        sink &operator<<(std::string_view text);
+        sink &operator<<(const char *text);
+        sink &operator<<(char ch);
+
+        template <std::integral T>
+        sink &operator<<(T value)
+        {
+            std::span<char> out = reserve(24);
+            auto r = std::to_chars(out.data(), out.data() + out.size(), value);
+            commit(r.ptr - out.data());
+            return *this;
+        }
+
+        template <std::floating_point T>
+        sink &operator<<(T value)
+        {
+            std::span<char> out = reserve(32);
+            auto r = std::to_chars(out.data(), out.data() + out.size(), value);
+            commit(r.ptr - out.data());
+            return *this;
+        }
+
+        /// \return Number of bytes written
+        std::size_t size() const;
+
+        /// \return Line number (1-based) of the next byte
+        int line() const;
+
+        /// \return Column number (1-based) of the next byte
+        int column() const;
+
+        /// \return Bookmark for the next byte, for line maps
+        bookmark mark() const;
+
+        /// \brief Flush the mapping, trim the file to `size()` and close it.
+        void close();
+
+    private:
+        /// \brief Make [size(), size() + n) part of the mapped window.
+        void map_window(std::size_t n);
+
+        int fd_;
+        std::size_t extent_;
+        std::size_t capacity_;
+        char *window_;
+        std::size_t window_offset_;
+        std::size_t window_size_;
+        std::size_t reserved_;
+        std::size_t size_;
+        int line_;
+        int column_;
+        char break_char_;
+    };
+
+    /// \brief Sorted index of newline byte positions for random access by line.
+    ///
+    /// Built by a single scan over a buffer; afterwards resolves any byte
+    /// position to its line and column in logarithmic time.
+    class line_index
+    {
+    public:
+        line_index() = default;
+
+        /// \brief Build the index by scanning \p size bytes at \p data.
+        ///
+        /// `line_ending::detect` is resolved from the first block of the data.
+        /// When \p hasher is given, each chunk is also hashed right after it
+        /// is scanned, so both are done in one pass over memory.
+        line_index(const char *data, std::size_t size, line_ending endings = line_ending::lf,
+                   content_hasher *hasher = nullptr);
+
+        /// \brief Adopt break positions found earlier (e.g. stored in a bundle).
+        /// \param newlines Sorted positions of the breaks of \p data
+        /// \param endings  Convention they were found with (not `detect`)
+        line_index(std::vector<std::size_t> newlines, const char *data, line_ending endings);
+
+        /// \return Line terminator convention the index was built with
+        line_ending endings() const;
+
+        /// \return Number of lines (at least 1, even for empty input)
+        std::size_t lines() const;
+
+        /// \return Line number (1-based) containing byte position \p pos
+        int line_of(std::size_t pos) const;
+
+        /// \return Column number (1-based) of byte position \p pos
+        int column_of(std::size_t pos) const;
+
+        /// \return Byte offset at which the given 1-based line starts
+        std::size_t line_start(std::size_t line) const;
+
+        /// \return Sorted byte positions of the last byte of each line break
+        const std::vector<std::size_t> &newline_positions() const;
+
+        /// \brief Update the index after bytes [begin, old_end) were replaced.
+        ///
+        /// Only the replacement, now at [begin, new_end) of \p data, is
+        /// scanned; breaks after it are shifted by the change in length.
+        /// \param data Complete new text
+        void update(const char *data, std::size_t begin, std::size_t old_end, std::size_t new_end);
+
+    private:
+        /// \brief Recompute the CRLF flags of breaks [first, last).
+        void flag_crlf(const char *data, std::size_t first, std::size_t last);
+
+        std::vector<std::size_t> newlines_;
+        /// In CRLF mode, whether each break is preceded by a zero-width '\r'
+        std::vector<bool> crlf_;
+        line_ending endings_ = line_ending::lf;
+    };
+
+    /// \brief One line of a `line_range`.
+    struct line_entry
+    {
+        std::size_t number;    ///< Line number (1-based)
+        std::string_view text; ///< Text of the line, without its terminator
+    };
+
+    /// \brief Random-access view of the lines of a text, backed by its line index.
+    ///
+    /// Elements are computed from the sorted break positions on dereference,
+    /// so the view holds no per-line storage and any line is reachable in
+    /// constant time. It composes with `std::views` and, its iterators being
+    /// random access, with the parallel standard algorithms. A break at the
+    /// very end of the text does not start another (empty) line.
+    class line_range : public std::ranges::view_interface<line_range>
+    {
+        /// The text and its breaks, shared by the range and its iterators
+        struct lines
+        {
+            const char *data = nullptr;
+            std::size_t size = 0;
+            const std::vector<std::size_t> *breaks = nullptr;
+            bool crlf = false;
+
+            line_entry at(std::size_t i) const
+            {
+                std::size_t start = i ? (*breaks)[i - 1] + 1 : 0;
+                std::size_t end = i < breaks->size() ? (*breaks)[i] : size;
+                if (crlf && i < breaks->size() && end > start && data[end - 1] == '\r')
+                    --end;
+                return line_entry{i + 1, std::string_view(data + start, end - start)};
+            }
+        };
+
+    public:
+        class iterator
+        {
+        public:
+            using iterator_concept = std::random_access_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = line_entry;
+            using difference_type = std::ptrdiff_t;
+            using reference = line_entry;
+            using pointer = void;
+
+            iterator() = default;
+            iterator(const lines &text, std::size_t line) : text_(text), line_(line) {}
+
+            line_entry operator*() const { return text_.at(line_); }
+            line_entry operator[](difference_type n) const { return text_.at(line_ + n); }
+
+            iterator &operator++() { ++line_; return *this; }
+            iterator operator++(int) { iterator t = *this; ++line_; return t; }
+            iterator &operator--() { --line_; return *this; }
+            iterator operator--(int) { iterator t = *this; --line_; return t; }
+            iterator &operator+=(difference_type n) { line_ += n; return *this; }
+            iterator &operator-=(difference_type n) { line_ -= n; return *this; }
+
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const iterator &a, const iterator &b)
+            {
+                return static_cast<difference_type>(a.line_) - static_cast<difference_type>(b.line_);
+            }
+            friend bool operator==(const iterator &a, const iterator &b) { return a.line_ == b.line_; }
+            friend auto operator<=>(const iterator &a, const iterator &b) { return a.line_ <=> b.line_; }
+
+        private:
+            lines text_;
+            std::size_t line_ = 0;
+        };
+
+        line_range() = default;
+
+        /// \param data  Text the index was built over
+        /// \param index Index of \p data; must outlive the range and its iterators
+        line_range(const char *data, std::size_t size, const line_index &index)
+            : text_{data, size, &index.newline_positions(), index.endings() == line_ending::crlf},
+              count_(text_.breaks->size() +
+                     (text_.breaks->empty() ? size > 0 : text_.breaks->back() + 1 < size))
+        {
+        }
+
+        iterator begin() const { return iterator(text_, 0); }
+        iterator end() const { return iterator(text_, count_); }
+        std::size_t size() const { return count_; }
+
+    private:
+        lines text_;
+        std::size_t count_ = 0;
+    };
+
+    /// \brief How a `source` keeps pages ahead of the read position resident.
+    enum class prefetch_mode
+    {
+        none,   ///< Rely on the kernel's own readahead only
+        advise, ///< Issue `MADV_WILLNEED` inline every `step` bytes read
+        thread  ///< A helper thread advises and touches pages ahead of the reader
+    };
+
+    /// \brief Configuration for read-ahead prefetching.
+    struct prefetch_options
+    {
+        prefetch_mode mode = prefetch_mode::advise;
+        std::size_t distance = 1 << 20; ///< Bytes to keep resident ahead of the position
+        std::size_t step = 64 << 10;    ///< Reader progress between prefetch requests
+    };
+
+    /// \brief Counters reported by the prefetcher.
+    struct prefetch_stats
+    {
+        std::size_t requests = 0;        ///< Prefetch windows issued
+        std::size_t pages_advised = 0;   ///< Pages covered by those windows
+        std::size_t faults_absorbed = 0; ///< Pages that were not resident when advised
+    };
+
+    /// \brief Keeps a window of a mapping resident ahead of a moving read position.
+    ///
+    /// The reader calls `advance()` whenever it has progressed by `step` bytes.
+    /// In `advise` mode the window is requested right away with `madvise`; in
+    /// `thread` mode a helper thread is woken to request and touch the pages,
+    /// so the reader never blocks on the resulting major faults. Pages found
+    /// non-resident (via `mincore`) are counted as absorbed faults.
+    class prefetcher
+    {
+    public:
+        prefetcher(const char *data, std::size_t size, const prefetch_options &opts);
+        ~prefetcher();
+
+        prefetcher(const prefetcher &) = delete;
+        prefetcher &operator=(const prefetcher &) = delete;
+
+        /// \brief Notify the prefetcher that the reader is at \p pos.
+        void advance(std::size_t pos);
+
+        /// \return Configured options
+        const prefetch_options &options() const;
+
+        /// \return Snapshot of the prefetch counters
+        prefetch_stats stats() const;
+
+    private:
+        void issue(std::size_t pos);
+        void run();
+
+        const char *data_;
+        std::size_t size_;
+        prefetch_options options_;
+        std::size_t page_size_;
+        std::size_t prefetched_to_;
+        std::vector<unsigned char> residency_;
+
+        std::atomic<std::size_t> requests_;
+        std::atomic<std::size_t> pages_advised_;
+        std::atomic<std::size_t> faults_absorbed_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::size_t target_;
+        bool pending_;
+        bool stopping_;
+        std::thread worker_;
+    };
+
+    /// \brief Character encoding of an input file.
+    enum class encoding
+    {
+        detect,  ///< Use the byte order mark; UTF-8 if there is none
+        utf8,    ///< UTF-8 (read in place, without copying)
+        utf16le, ///< UTF-16, little endian
+        utf16be, ///< UTF-16, big endian
+        latin1   ///< ISO-8859-1
+    };
+
+    /// \brief Identify the encoding from a byte order mark.
+    ///
+    /// \param bom_length Receives the length of the byte order mark (0 if none)
+    /// \return Detected encoding, `encoding::utf8` if there is no mark
+    encoding detect_encoding(const char *data, std::size_t size, std::size_t &bom_length);
+
+    /// \return Upper bound on the UTF-8 size of \p size bytes in encoding \p enc
+    std::size_t utf8_capacity(encoding enc, std::size_t size);
+
+    /// \brief Convert a block of UTF-16 or Latin-1 input to UTF-8.
+    ///
+    /// Runs of ASCII are converted 16 bytes at a time. A surrogate pair (or
+    /// odd byte) split at the end of the block is left unconsumed unless
+    /// \p last is set, in which case it is replaced by U+FFFD.
+    ///
+    /// \param out      Output buffer of at least `utf8_capacity(enc, size)` bytes
+    /// \param consumed Receives the number of input bytes converted
+    /// \return Number of bytes written to \p out
+    std::size_t transcode_to_utf8(encoding enc, const char *in, std::size_t size,
+                                  char *out, bool last, std::size_t &consumed);
+
+    /// \brief Snapshot of instrumentation counters for a source (or the whole process).
+    ///
+    /// Counters are only maintained when the library is built with
+    /// `MMS_ENABLE_STATS`; otherwise every snapshot is all zeros.
+    struct source_stats
+    {
+        std::uint64_t gets = 0;           ///< Calls to get()
+        std::uint64_t peeks = 0;          ///< Calls to peek()
+        std::uint64_t putbacks = 0;       ///< Calls to putback()
+        std::uint64_t seeks_bookmark = 0; ///< Seeks resolved from a bookmark
+        std::uint64_t seeks_index = 0;    ///< Seeks resolved through the line index
+        std::uint64_t seeks_rescan = 0;   ///< Seeks resolved by rescanning tracked newlines
+        std::uint64_t splices = 0;        ///< Reads that stepped over line continuations
+        std::uint64_t index_builds = 0;   ///< Line indexes built
+        std::uint64_t index_build_ns = 0; ///< Time spent building line indexes
+        std::uint64_t index_lines = 0;    ///< Lines recorded by those indexes
+        std::uint64_t mapped_bytes = 0;   ///< Size of the mapping(s)
+        std::uint64_t resident_bytes = 0; ///< Bytes of the mapping resident in memory (mincore)
+        std::uint64_t major_faults = 0;   ///< Major page faults of the process; `global_stats()` only
+        std::uint64_t minor_faults = 0;   ///< Minor page faults of the process; `global_stats()` only
+
+        source_stats &operator+=(const source_stats &other);
+    };
+
+    /// \brief True if the library was built with instrumentation counters.
+#if defined(MMS_STATS) && MMS_STATS
+    inline constexpr bool stats_enabled = true;
+#define MMS_STAT(stmt) stmt
+#else
+    inline constexpr bool stats_enabled = false;
+#define MMS_STAT(stmt) ((void)0)
+#endif
+
+    /// \brief Process-wide aggregate of all source counters.
+    ///
+    /// Sources contribute their counters when destroyed; line index builds
+    /// of sources and mapped sources are added as they happen. Residency covers live sources only, and
+    /// fault counts are sampled for the whole process.
+    source_stats global_stats();
+
+    /// \return Number of bytes of [addr, addr + size) resident in memory
+    std::size_t resident_bytes(const void *addr, std::size_t size);
+
+    namespace detail
+    {
+        /// \brief Add counters to the process-wide aggregate.
+        void accumulate_stats(const source_stats &s);
+
+        /// \brief Track live mapped bytes for the process-wide aggregate.
+        void track_mapping(const void *addr, std::size_t size, bool add);
+
+        /// \brief Times a line index build from construction to `done`.
+        class index_build_timer
+        {
+        public:
+            index_build_timer();
+
+            /// \brief Add the build of an index with \p lines lines to the aggregate and to \p local.
+            void done(std::size_t lines, source_stats *local = nullptr) const;
+
+        private:
+            std::uint64_t started_ns_;
+        };
+    }
+
+    /// \brief Compact location of a token: byte offset plus 1-based line and column.
+    struct location
+    {
+        std::size_t offset = 0;
+        std::uint32_t line = 1;
+        std::uint32_t column = 1;
+    };
+
+    /// \brief An occurrence found by `source::find`.
+    struct match
+    {
+        location where;          ///< Start of the occurrence
+        std::size_t length = 0;  ///< Length in bytes
+        std::size_t pattern = 0; ///< Index of the pattern in its `pattern_set` (0 for a single needle)
+    };
+
+    /// \brief A set of keywords searched for all at once (Aho-Corasick).
+    ///
+    /// Built once; the automaton's transitions are stored per byte class, as
+    /// in `make_dfa`, so the table stays small. While no pattern is partially
+    /// matched, the search skips ahead to the next possible first byte with a
+    /// vectorized scan when the patterns begin with at most three distinct
+    /// bytes. Matches are leftmost-longest and do not overlap.
+    class pattern_set
+    {
+    public:
+        /// \throws std::invalid_argument if a pattern is empty
+        pattern_set(std::initializer_list<std::string_view> patterns);
+        explicit pattern_set(const std::vector<std::string> &patterns);
+
+        /// \return Number of patterns
+        std::size_t size() const;
+
+        /// \return Pattern \p i
+        std::string_view pattern(std::size_t i) const;
+
+        /// \brief Find the leftmost (then longest) match starting at or after \p from.
+        /// \param length  Receives the length of the match
+        /// \param pattern Receives the index of the matched pattern
+        /// \return Start offset of the match, or `std::string_view::npos`
+        std::size_t find(std::string_view text, std::size_t from,
+                         std::size_t &length, std::size_t &pattern) const;
+
+    private:
+        void build();
+
+        std::vector<std::string> patterns_;
+        std::array<std::uint16_t, 256> classes_{};
+        std::size_t class_count_ = 0;
+        /// Transitions, `class_count_` per state; state 0 is the root
+        std::vector<std::uint32_t> next_;
+        /// Length of the trie path leading to each state
+        std::vector<std::uint32_t> depth_;
+        /// Longest pattern ending at each state (via suffix links), or -1
+        std::vector<std::int32_t> longest_;
+        /// Distinct first bytes, used to skip ahead when at the root
+        std::string first_bytes_;
+    };
+
+    /// \brief A replaced byte range: [begin, old_end) of the old text is now [begin, new_end).
+    struct text_change
+    {
+        std::size_t begin = 0;
+        std::size_t old_end = 0;
+        std::size_t new_end = 0;
+
+        /// \brief Map position \p pos of the old text onto the new text.
+        /// \return False if \p pos lay inside the replaced bytes
+        bool shift(std::size_t &pos) const
+        {
+            if (pos <= begin)
+                return true; // everything before it is unchanged
+            if (pos < old_end)
+                return false;
+            pos = pos - old_end + new_end;
+            return true;
+        }
     };
 
     /// \brief Provides a lightweight, stream-like interface for reading source files.
@@ -134,7 +1020,25 @@ namespace mms
     {
     public:
         /// \brief Open and prepare the source from a memory-mapped file.
-        explicit source(const char *filename);
+        ///
+        /// UTF-8 input is read straight from the mapping (after skipping any
+        /// byte order mark). Other encodings are converted to UTF-8 in chunks
+        /// as reading proceeds; `data()`, `size()` and `index()` convert the
+        /// remainder at once.
+        explicit source(const char *filename,
+                        line_ending endings = line_ending::detect,
+                        encoding enc = encoding::detect);
+
+        /// \brief Prepare the source from an already mapped file.
+        explicit source(file f,
+                        line_ending endings = line_ending::detect,
+                        encoding enc = encoding::detect);
+
+        /// \brief Open a source without throwing (see `file::open`).
+        static result<std::unique_ptr<source>> open(const char *filename,
+                                                    line_ending endings = line_ending::detect,
+                                                    encoding enc = encoding::detect) noexcept;
+        ~source();
 
         /// \brief Read next character and advance position. Returns EOF on end.
         int get();
@@ -163,24 +1067,1959 @@ namespace mms
         /// \brief Seek back to a previously stored bookmark.
         void seek(const bookmark &b);
 
-        /// \brief Return raw pointer to mapped file data.
-        const char *data() const;
+        /// \brief Seek to an arbitrary byte position.
+        ///
+        /// Resolved from a tracker bookmark if one exists at \p pos, by
+        /// rescanning the newlines seen so far if \p pos lies in the region
+        /// already read, and through the line index otherwise.
+        void seek(std::size_t pos);
 
-        /// \brief Return total file size in bytes.
-        std::size_t size() const;
+        /// \brief Find the first occurrence of \p needle at or after \p from.
+        ///
+        /// Candidates are located by comparing the first and last byte of
+        /// the needle against 16 positions at once; line and column are
+        /// resolved through the line index. Does not move the read position.
+        /// \throws std::invalid_argument if \p needle is empty
+        std::optional<match> find(std::string_view needle, std::size_t from = 0) const;
 
-    private:
-        file file_;
-        postrack tracker_;
-    };
+        /// \brief Find the leftmost-longest match of any of \p patterns at or after \p from.
+        std::optional<match> find(const pattern_set &patterns, std::size_t from = 0) const;
 
-    /// \brief Extract the next word (non-whitespace token) from the stream.
-    source &operator>>(source &s, std::string &out);
+        /// \return All non-overlapping occurrences of \p needle, in order
+        std::vector<match> find_all(std::string_view needle) const;
 
-    /// \brief Extract an integer from the stream.
-    source &operator>>(source &s, int &value);
+        /// \return All non-overlapping matches of \p patterns, in order
+        std::vector<match> find_all(const pattern_set &patterns) const;
 
-    /// \brief Extract a single character from the stream.
-    source &operator>>(source &s, char &ch);
+        /// \brief Seek to the next occurrence of \p needle at or after the read position.
+        /// \return False (without moving) if there is none
+        bool seek_next(std::string_view needle);
 
-} // namespace mms
+        /// \brief Seek to the next match of \p patterns at or after the read position.
+        bool seek_next(const pattern_set &patterns);
+
+        /// \brief Count columns in bytes (the default) or in UTF-8 code points.
+        ///
+        /// See `postrack::set_column_unit`. Bookmarks keep the column in the
+        /// unit in effect when they were taken.
+        void set_column_unit(column_unit unit, std::size_t checkpoint_interval = 4096);
+
+        /// \brief Skip backslash-newline line continuations while reading.
+        ///
+        /// `get()`, `peek()` and the extraction operators then see the
+        /// logical text, in which each backslash directly followed by a line
+        /// break is removed, while `position()`, `line()` and `column()`
+        /// keep reporting the physical location. Continuations are found 16
+        /// bytes at a time ahead of the read position and `get()` leaves its
+        /// fast path only at them; nothing is copied. Searching, `lines()`
+        /// and the line index still work on the physical text.
+        void set_splicing(bool on);
+
+        /// \return True if line continuations are skipped
+        bool splicing() const;
+
+        /// \return Offset in the logical text of the physical offset \p physical
+        ///
+        /// Offsets inside a continuation map to the character after it.
+        std::size_t logical_offset(std::size_t physical) const;
+
+        /// \return Physical offset of the logical offset \p logical
+        std::size_t physical_offset(std::size_t logical) const;
+
+        /// \return Physical offset, line and column of the logical offset \p logical
+        location physical_location(std::size_t logical) const;
+
+        /// \brief Return the line index, building it on first call.
+        const line_index &index() const;
+
+        /// \brief Digest of the file's bytes (see `file::content_digest`).
+        ///
+        /// If the line index has not been built yet and the file is read in
+        /// place, the two are computed together in one pass.
+        digest content_digest() const;
+
+        /// \brief Range over all lines as `{number, text}` pairs.
+        ///
+        /// Builds the line index on first call. The range stays valid until
+        /// the source is reloaded or destroyed.
+        line_range lines() const;
+
+        /// \return Line terminator convention (never `detect`)
+        line_ending endings() const;
+
+        /// \return Encoding of the underlying file (never `detect`)
+        encoding input_encoding() const;
+
+        /// \brief Return pointer to the UTF-8 text (the mapping itself for UTF-8 files).
+        const char *data() const;
+
+        /// \brief Return total size of the UTF-8 text in bytes.
+        std::size_t size() const;
+
+        /// \return Path the source was opened from (empty if opened from a descriptor)
+        const std::string &path() const;
+
+        /// \brief Snapshot of this source's instrumentation counters.
+        ///
+        /// Page faults cannot be attributed to one mapping and are left at
+        /// zero; `global_stats()` reports them for the process.
+        source_stats stats() const;
+
+        /// \brief Start prefetching pages ahead of the read position.
+        void enable_prefetch(const prefetch_options &opts = {});
+
+        /// \return Prefetch counters (all zero if prefetching is disabled)
+        prefetch_stats prefetch_statistics() const;
+
+        /// \brief Fingerprint the text so that `reload()` can find what changed.
+        ///
+        /// Hashes the text in fixed-size blocks, aligned both to its start and
+        /// to its end. Must be called before the file changes on disk.
+        void enable_change_tracking();
+
+        /// \brief Re-read the file after it changed on disk.
+        ///
+        /// The unchanged prefix and suffix are found by comparing block
+        /// hashes; the line index is updated by scanning only the changed
+        /// region. The read position moves with the text (to the start of
+        /// the change if it was inside it). Without change tracking the whole
+        /// text counts as changed.
+        /// \return True if the text changed
+        bool reload();
+
+        /// \return Number of reloads that changed the text
+        std::uint32_t generation() const;
+
+        /// \return Region replaced by the latest reload that changed the text
+        text_change last_change() const;
+
+        /// \brief Move a bookmark from an earlier generation onto the current text.
+        ///
+        /// `seek()` does this itself; use it for bookmarks stored elsewhere.
+        /// \return False if the bookmarked text has since been replaced
+        bool rebase(bookmark &b) const;
+
+    private:
+        /// \brief Column of \p pos in the tracker's unit, resolved through the line index.
+        int resolve_column(std::size_t pos) const;
+
+        /// \brief Resolve the line and column of a match starting at \p offset.
+        match resolve(std::size_t offset, std::size_t length, std::size_t pattern) const;
+
+        /// \brief Slow path of `get()` once the position reaches `horizon_`.
+        bool cross_horizon(std::size_t pos);
+
+        /// \brief A line continuation, as the offsets just past it.
+        ///
+        /// The bytes removed by all continuations up to and including this
+        /// one are `physical - logical`.
+        struct splice
+        {
+            std::size_t physical;
+            std::size_t logical;
+        };
+
+        /// \brief Record the continuations in the text converted so far.
+        void find_splices() const;
+
+        /// \return \p pos, moved past any continuations that start at or span it
+        std::size_t past_splices(std::size_t pos) const;
+
+        /// \return Start of the first known continuation ending after \p pos, or `SIZE_MAX`
+        std::size_t next_splice(std::size_t pos) const;
+
+        /// \brief Convert the next chunk of input. Returns false at end of input.
+        bool decode_more() const;
+
+        /// \brief Convert all remaining input.
+        void decode_all() const;
+
+        file file_;
+        encoding encoding_;
+        /// Encoding asked for at construction; only `detect` re-detects on reload
+        encoding requested_;
+        std::size_t bom_length_;
+
+        /// UTF-8 text being read: the mapping, or `decoded_` when transcoding.
+        const char *data_;
+        mutable std::size_t avail_;
+        mutable std::unique_ptr<char[]> decoded_;
+        /// Input bytes (after the byte order mark) converted so far
+        mutable std::size_t consumed_;
+
+        postrack tracker_;
+
+        /// Position at which `get()` leaves its fast path (EOF or next prefetch step).
+        std::size_t horizon_;
+        std::unique_ptr<prefetcher> prefetcher_;
+
+        mutable std::unique_ptr<line_index> index_;
+        /// Set once a seek skipped unread text, so tracked newlines are incomplete.
+        bool skipped_;
+
+        /// Block hashes of the text, aligned to its start and to its end
+        std::vector<std::uint64_t> head_hashes_;
+        std::vector<std::uint64_t> tail_hashes_;
+        bool tracking_;
+        /// Changes made by each reload; the size is the generation
+        std::vector<text_change> changes_;
+
+        friend class bundle; // supplies stored line indexes
+
+        bool splicing_;
+        /// Continuations found so far, in order
+        mutable std::vector<splice> splices_;
+        /// Offset up to which the text has been searched for continuations
+        mutable std::size_t spliced_to_;
+
+#if defined(MMS_STATS) && MMS_STATS
+        mutable source_stats counters_;
+#endif
+    };
+
+    /// \brief Reloads sources when their files change on disk (Linux inotify).
+    ///
+    /// Watches the directory of each file, so both in-place writes and the
+    /// write-to-temporary-and-rename saves most editors use are seen. Sources
+    /// must be removed before they are destroyed. If the kernel's event queue
+    /// overflows, every watched source is reloaded; sources in a directory
+    /// that is deleted stop being watched.
+    class file_watcher
+    {
+    public:
+        file_watcher();
+        ~file_watcher();
+
+        file_watcher(const file_watcher &) = delete;
+        file_watcher &operator=(const file_watcher &) = delete;
+
+        /// \brief Start watching the file of \p s and enable its change tracking.
+        void add(source &s);
+
+        /// \brief Stop watching \p s; the directory watch goes with its last source.
+        void remove(source &s);
+
+        /// \return Descriptor that becomes readable when a change is pending, for poll/epoll loops
+        int descriptor() const;
+
+        /// \brief Wait up to \p timeout_ms for changes and reload the affected sources.
+        /// \return Sources whose text changed
+        std::vector<source *> poll(int timeout_ms = 0);
+
+    private:
+        /// \brief Forget the directory watched by \p wd and its sources.
+        void forget_directory(int wd);
+
+        int fd_;
+        /// Watch descriptor of each watched directory
+        std::map<std::string, int> directories_;
+        /// Sources by (watch descriptor, file name)
+        std::map<std::pair<int, std::string>, std::vector<source *>> sources_;
+    };
+
+    /// \brief Immutable, thread-safe memory-mapped file shared by many readers.
+    ///
+    /// Owns the mapping and a lazily built line index. All members are const
+    /// and may be called concurrently. The index is built once, on first use,
+    /// by whichever thread claims it first and published with a single atomic
+    /// store; threads asking meanwhile wait for it.
+    /// Reading state lives in `cursor` objects created over this mapping.
+    class mapped_source
+    {
+    public:
+        /// \brief Open and memory-map the file.
+        explicit mapped_source(const char *filename, line_ending endings = line_ending::detect);
+        ~mapped_source();
+
+        mapped_source(const mapped_source &) = delete;
+        mapped_source &operator=(const mapped_source &) = delete;
+
+        /// \return Pointer to the mapped file data
+        const char *data() const;
+
+        /// \return Size of the mapped file in bytes
+        std::size_t size() const;
+
+        /// \brief Return the line index, building it on first call.
+        const line_index &index() const;
+
+        /// \return True if the line index has already been published
+        bool has_index() const;
+
+        /// \return Line terminator convention (never `detect`)
+        line_ending endings() const;
+
+    private:
+        file file_;
+        line_ending endings_;
+        mutable std::atomic<const line_index *> index_;
+        /// Set while a thread builds the index
+        mutable std::atomic<bool> building_;
+    };
+
+    /// \brief Lightweight per-thread reading position over a `mapped_source`.
+    ///
+    /// Offers the same reading interface as `source`, but holds only a pointer
+    /// and the current position, so any number of cursors can be created
+    /// cheaply over one shared mapping. A cursor must not outlive its source.
+    class cursor
+    {
+    public:
+        /// \brief Create a cursor positioned at the start of \p src.
+        explicit cursor(const mapped_source &src);
+
+        /// \brief Read next character and advance position. Returns EOF on end.
+        int get();
+
+        /// \brief Peek next character without advancing. Returns EOF on end.
+        int peek() const;
+
+        /// \brief Put back the last character.
+        void putback();
+
+        /// \brief Check if the cursor is still valid (i.e., not EOF).
+        explicit operator bool() const;
+
+        /// \brief Get current byte position in the file.
+        std::size_t position() const;
+
+        /// \brief Get current line number (1-based).
+        int line() const;
+
+        /// \brief Get current column number (1-based).
+        int column() const;
+
+        /// \brief Create a bookmark for the current location.
+        bookmark mark() const;
+
+        /// \brief Seek to a previously stored bookmark.
+        void seek(const bookmark &b);
+
+        /// \brief Seek to an arbitrary byte position (resolved via the line index).
+        void seek(std::size_t pos);
+
+        /// \brief Return raw pointer to mapped file data.
+        const char *data() const;
+
+        /// \brief Return total file size in bytes.
+        std::size_t size() const;
+
+        /// \brief Line ending convention of the underlying source.
+        line_ending endings() const;
+
+    private:
+        /// \return True if the '\r' at \p pos takes no column
+        bool is_zero_width_cr(std::size_t pos) const;
+
+        const mapped_source *source_;
+        std::size_t pos_;
+        int line_;
+        int column_;
+        char break_char_;
+    };
+
+    /// \brief Editable view of a `source`: a piece table over its read-only text.
+    ///
+    /// The document is a sequence of pieces, each a run of either the
+    /// original text or an append-only buffer of inserted text. Edits split
+    /// and replace pieces and never copy or modify the original. Line
+    /// breaks are looked up per piece, in the base source's line index or in
+    /// the breaks recorded when text was inserted, so an edit scans only the
+    /// inserted bytes and then updates per-piece totals.
+    ///
+    /// Offers the same reading interface as `source` over the edited
+    /// document. Bookmarks taken before an edit are moved with the text by
+    /// `seek()`, as after `source::reload()`. The base source must outlive
+    /// the overlay and must not be reloaded while it is in use.
+    class overlay
+    {
+    public:
+        /// \brief Start with the unedited text of \p base.
+        explicit overlay(const source &base);
+
+        /// \brief Replace \p length bytes at \p pos with \p text.
+        void replace(std::size_t pos, std::size_t length, std::string_view text);
+
+        /// \brief Insert \p text before byte \p pos.
+        void insert(std::size_t pos, std::string_view text);
+
+        /// \brief Remove \p length bytes at \p pos.
+        void erase(std::size_t pos, std::size_t length);
+
+        /// \return Size of the edited document in bytes
+        std::size_t size() const;
+
+        /// \return Number of lines in the edited document
+        std::size_t lines() const;
+
+        /// \return Line number (1-based) of byte position \p pos
+        int line_of(std::size_t pos) const;
+
+        /// \return Column number (1-based) of byte position \p pos
+        int column_of(std::size_t pos) const;
+
+        /// \return Byte offset at which the given 1-based line starts
+        std::size_t line_start(std::size_t line) const;
+
+        /// \return Copy of the edited document
+        std::string str() const;
+
+        /// \return Number of pieces the document consists of
+        std::size_t pieces() const;
+
+        /// \return Number of edits applied
+        std::uint32_t generation() const;
+
+        /// \return Region replaced by the latest edit
+        text_change last_change() const;
+
+        /// \brief Read next character and advance position. Returns EOF on end.
+        int get();
+
+        /// \brief Peek next character without advancing. Returns EOF on end.
+        int peek() const;
+
+        /// \brief Put back the last character (1 level only).
+        void putback();
+
+        /// \brief Check if characters remain.
+        explicit operator bool() const;
+
+        /// \return Current byte position in the document
+        std::size_t position() const;
+
+        /// \return Current line number (1-based)
+        int line() const;
+
+        /// \return Current column number (1-based)
+        int column() const;
+
+        /// \brief Create a bookmark for the current location.
+        bookmark mark() const;
+
+        /// \brief Seek to a bookmark, moving it over later edits.
+        void seek(const bookmark &b);
+
+        /// \brief Seek to an arbitrary byte position.
+        void seek(std::size_t pos);
+
+    private:
+        struct piece
+        {
+            bool added;         ///< Run of the insert buffer rather than the original
+            std::size_t start;  ///< Offset in its buffer
+            std::size_t length;
+        };
+
+        /// \return Text of buffer of piece \p p
+        const char *buffer(const piece &p) const;
+
+        /// \return Sorted break positions of the buffer of piece \p p
+        const std::vector<std::size_t> &breaks(const piece &p) const;
+
+        /// \return Index of the piece holding byte \p pos (the last piece for `size()`)
+        std::size_t piece_at(std::size_t pos) const;
+
+        /// \return Byte at \p pos
+        char at(std::size_t pos) const;
+
+        /// \brief Split the piece holding \p pos so that a piece starts there; returns its index.
+        std::size_t split(std::size_t pos);
+
+        /// \brief Recompute piece offsets and line totals.
+        void refresh();
+
+        /// \brief Point the reader at piece \p k, offset \p within.
+        void enter(std::size_t k, std::size_t within);
+
+        /// \return True if the '\r' at \p pos takes no column
+        bool is_zero_width_cr(std::size_t pos) const;
+
+        const char *original_;
+        const std::vector<std::size_t> *original_breaks_;
+        std::string added_;
+        std::vector<std::size_t> added_breaks_;
+        line_ending endings_;
+        char break_char_;
+
+        std::vector<piece> pieces_;
+        /// Document offset at which each piece starts, plus the total size
+        std::vector<std::size_t> offsets_;
+        /// Line breaks before each piece, plus the total
+        std::vector<std::size_t> breaks_before_;
+        std::vector<text_change> changes_;
+
+        // Reader
+        std::size_t piece_;
+        const char *cur_;
+        const char *end_;
+        std::size_t pos_;
+        int line_;
+        int column_;
+    };
+
+    /// \brief Options for `batch_opener`.
+    struct batch_options
+    {
+        line_ending endings = line_ending::detect;
+        encoding enc = encoding::detect;
+        /// Files in flight or opened ahead of the consumer at once
+        unsigned queue_depth = 64;
+        /// Worker threads for the fallback path; 0 selects the hardware concurrency
+        unsigned threads = 0;
+        /// Try io_uring before falling back to worker threads
+        bool use_io_uring = true;
+        /// Ask the kernel to start reading files of 64 KB and more before they are returned
+        bool readahead = true;
+    };
+
+    /// \brief A file opened by `batch_opener`.
+    struct opened_source
+    {
+        /// Position of the path in the list given to the opener
+        std::size_t index = 0;
+        /// The source, or null if opening failed
+        std::unique_ptr<source> src;
+        /// Why opening failed (the exception `source` itself would have thrown)
+        std::exception_ptr error;
+    };
+
+    /// \brief Opens many files concurrently and hands them out as they complete.
+    ///
+    /// On Linux the opens, size queries and readahead hints are submitted
+    /// in batches through io_uring and driven from the thread calling
+    /// `next()`. When io_uring is unavailable (old kernel, seccomp, or
+    /// disabled by options) a pool of worker threads opens the files with
+    /// the ordinary `source` constructor instead.
+    class batch_opener
+    {
+    public:
+        explicit batch_opener(std::vector<std::string> paths, const batch_options &opts = {});
+        ~batch_opener();
+
+        batch_opener(const batch_opener &) = delete;
+        batch_opener &operator=(const batch_opener &) = delete;
+
+        /// \brief Wait for the next file to finish opening, in completion order.
+        /// \return The opened file, or nothing once every path has been returned
+        std::optional<opened_source> next();
+
+        /// \return True if files are opened through io_uring
+        bool uses_io_uring() const;
+
+        /// \return Number of paths given to the opener
+        std::size_t size() const;
+
+    private:
+        struct ring;
+
+        /// \brief Fallback: worker thread body.
+        void work();
+
+        std::vector<std::string> paths_;
+        batch_options opts_;
+        std::size_t delivered_;
+
+        std::unique_ptr<ring> ring_;
+
+        std::vector<std::thread> workers_;
+        std::atomic<std::size_t> next_path_;
+        std::atomic<bool> stop_;
+        std::mutex mutex_;
+        std::condition_variable ready_cv_;
+        /// Signalled when a delivered file frees a place in the window
+        std::condition_variable space_cv_;
+        std::deque<opened_source> ready_;
+        /// Files claimed by workers and not yet delivered, at most `queue_depth`
+        std::size_t pending_ = 0;
+    };
+
+    /// \brief Packs many small files into one bundle file.
+    ///
+    /// A bundle holds the bytes of each member, its path, its line ending
+    /// and, for UTF-8 members, the positions of its line breaks, so that a
+    /// `bundle` can hand out members with a ready line index. It is meant
+    /// for inputs known up front, such as the headers of a hermetic build.
+    class bundle_builder
+    {
+    public:
+        /// \brief Add the file at \p path, stored under the same path.
+        void add(const std::string &path);
+
+        /// \brief Add the file at \p path, stored as \p name.
+        void add(std::string name, const std::string &path);
+
+        /// \return Number of files added
+        std::size_t size() const;
+
+        /// \brief Write the bundle to \p filename.
+        /// \throws std::invalid_argument if two members have the same name
+        void write(const char *filename) const;
+
+    private:
+        /// Stored name and path on disk of each member
+        std::vector<std::pair<std::string, std::string>> members_;
+    };
+
+    /// \brief Reads a bundle written by `bundle_builder` through a single mapping.
+    ///
+    /// Opening the bundle maps it once and reads its member table; opening a
+    /// member costs no system call. Members are `source` objects over their
+    /// part of the mapping, numbering lines and columns from their own start,
+    /// with the stored line index in place. They keep the mapping alive, so
+    /// they may outlive the bundle.
+    class bundle
+    {
+    public:
+        /// \brief Map the bundle at \p filename.
+        /// \throws std::ios_base::failure if it cannot be opened or is not a bundle
+        /// \throws std::out_of_range if its tables point outside the file
+        explicit bundle(const char *filename);
+
+        /// \return Number of members
+        std::size_t size() const;
+
+        /// \return Stored path of member \p i (members are sorted by path)
+        std::string_view path(std::size_t i) const;
+
+        /// \return Index of the member stored as \p path, if any
+        std::optional<std::size_t> find(std::string_view path) const;
+
+        /// \return Bytes of member \p i, inside the mapping
+        std::string_view contents(std::size_t i) const;
+
+        /// \brief Open member \p i as a source.
+        std::unique_ptr<source> open(std::size_t i) const;
+
+        /// \brief Open the member stored as \p path.
+        /// \throws std::ios_base::failure if there is none
+        std::unique_ptr<source> open(std::string_view path) const;
+
+    private:
+        /// \brief A member table entry, resolved to the mapping.
+        struct member
+        {
+            std::string_view path;
+            std::string_view text;
+            line_ending endings;
+            std::size_t index_offset; ///< Offset of its break positions (0 if none)
+            std::size_t breaks;       ///< Number of break positions
+        };
+
+        std::shared_ptr<const file> file_;
+        std::vector<member> members_;
+    };
+
+    /// \brief Position in a `source_stack`: one bookmark per file on the stack.
+    struct stack_bookmark
+    {
+        /// Frame id and position of each active file, outermost first
+        std::vector<std::pair<std::size_t, bookmark>> frames;
+    };
+
+    /// \brief One entry of an include chain, for diagnostics.
+    struct include_frame
+    {
+        std::string path;
+        int line = 1;
+        int column = 1;
+    };
+
+    /// \brief Stack of sources for nested (#include-style) reading.
+    ///
+    /// Reads like a single `source`. `push()` opens a file that is read
+    /// before the rest of the current one; when a pushed file is exhausted,
+    /// `get()` pops it and continues in the file that included it. Reads go
+    /// straight to the top source through a cached pointer; the stack is
+    /// only consulted when that source reports EOF.
+    ///
+    /// Popped files stay mapped so `stack_bookmark`s into them remain valid
+    /// and lookahead may cross include boundaries; `release_inactive()`
+    /// unmaps them once such bookmarks are no longer needed.
+    class source_stack
+    {
+    public:
+        /// \brief Open the outermost file.
+        explicit source_stack(const char *filename,
+                              line_ending endings = line_ending::detect,
+                              encoding enc = encoding::detect);
+        ~source_stack();
+
+        source_stack(const source_stack &) = delete;
+        source_stack &operator=(const source_stack &) = delete;
+
+        /// \brief Open \p filename and continue reading from its start.
+        void push(const char *filename,
+                  line_ending endings = line_ending::detect,
+                  encoding enc = encoding::detect);
+
+        /// \brief Abandon the innermost file and resume the one that included it.
+        void pop();
+
+        /// \return Number of files on the stack (at least 1)
+        std::size_t depth() const;
+
+        /// \return The innermost file being read
+        source &top();
+        const source &top() const;
+
+        /// \return Path of the innermost file
+        const std::string &file_name() const;
+
+        /// \return Files on the stack, outermost first, each with its current line and column
+        std::vector<include_frame> include_chain() const;
+
+        /// \brief Read next character, popping exhausted files. Returns EOF at the end of the outermost file.
+        int get();
+
+        /// \brief Peek next character without advancing, looking through exhausted files.
+        int peek() const;
+
+        /// \brief Put back the last character (1 level only), also across an automatic pop.
+        void putback();
+
+        /// \brief Check if any file on the stack has characters left.
+        explicit operator bool() const;
+
+        /// \return Byte position in the innermost file
+        std::size_t position() const;
+
+        /// \return Line number (1-based) in the innermost file
+        int line() const;
+
+        /// \return Column number (1-based) in the innermost file
+        int column() const;
+
+        /// \brief Create a bookmark for the current location, including the stack shape.
+        stack_bookmark mark() const;
+
+        /// \brief Restore the stack shape and all positions stored in \p b.
+        void seek(const stack_bookmark &b);
+
+        /// \brief Unmap files that are no longer on the stack.
+        ///
+        /// Bookmarks that refer to a released file can no longer be used.
+        void release_inactive();
+
+    private:
+        /// \brief Pop exhausted files. Returns false if only the exhausted outermost file remains.
+        bool underflow();
+
+        struct frame
+        {
+            std::unique_ptr<source> src;
+            std::string path;
+        };
+
+        /// Every file opened, indexed by frame id
+        std::vector<frame> frames_;
+        /// Frame ids of the files on the stack, outermost first
+        std::vector<std::size_t> chain_;
+        source *top_;
+        /// Frame popped by the last automatic pop, and the position it resumed at
+        std::size_t popped_;
+        std::size_t popped_at_;
+    };
+
+    /// \brief Extract the next word (non-whitespace token) from the stream.
+    source &operator>>(source &s, std::string &out);
+
+    /// \brief Extract an integer from the stream.
+    source &operator>>(source &s, int &value);
+
+    /// \brief Extract a single character from the stream.
+    source &operator>>(source &s, char &ch);
+
+    /// \brief Extract the next word (non-whitespace token) from a cursor.
+    cursor &operator>>(cursor &c, std::string &out);
+
+    /// \brief Extract an integer from a cursor.
+    cursor &operator>>(cursor &c, int &value);
+
+    /// \brief Extract a single character from a cursor.
+    cursor &operator>>(cursor &c, char &ch);
+
+    /// \brief Extract the next word (non-whitespace token) from a source stack.
+    source_stack &operator>>(source_stack &s, std::string &out);
+
+    /// \brief Extract an integer from a source stack.
+    source_stack &operator>>(source_stack &s, int &value);
+
+    /// \brief Extract a single character from a source stack.
+    source_stack &operator>>(source_stack &s, char &ch);
+
+    /// \brief Extract the next word (non-whitespace token) from an overlay.
+    overlay &operator>>(overlay &o, std::string &out);
+
+    /// \brief Extract an integer from an overlay.
+    overlay &operator>>(overlay &o, int &value);
+
+    /// \brief Extract a single character from an overlay.
+    overlay &operator>>(overlay &o, char &ch);
+
+    /// \brief Read an integer without throwing.
+    /// \return The integer, or `errc::invalid_integer` if no digits follow the whitespace
+    result<int> read_int(source &s) noexcept;
+
+    /// \brief Read the next non-whitespace character without throwing.
+    /// \return The character, or `errc::unexpected_eof`
+    result<char> read_char(source &s) noexcept;
+
+    /// \brief Read an integer from a cursor without throwing.
+    result<int> read_int(cursor &c) noexcept;
+
+    /// \brief Read the next non-whitespace character from a cursor without throwing.
+    result<char> read_char(cursor &c) noexcept;
+
+    /// \brief Read an integer from a source stack without throwing.
+    result<int> read_int(source_stack &s) noexcept;
+
+    /// \brief Read the next non-whitespace character from a source stack without throwing.
+    result<char> read_char(source_stack &s) noexcept;
+
+    /// \brief Read an integer from an overlay without throwing.
+    result<int> read_int(overlay &o) noexcept;
+
+    /// \brief Read the next non-whitespace character from an overlay without throwing.
+    result<char> read_char(overlay &o) noexcept;
+
+    /// \brief Field separation rules for `record_scanner`.
+    struct record_options
+    {
+        char delimiter = ',';      ///< Field separator (ignored when `whitespace` is set)
+        char quote = '"';          ///< Quote character, doubled inside a quoted field; '\0' for none
+        bool whitespace = false;   ///< Fields are separated by runs of blanks and tabs; no quoting
+        bool skip_empty = true;    ///< Skip lines that hold no data
+    };
+
+    /// \brief Reads delimited records (CSV, TSV, blank-separated columns) from a text.
+    ///
+    /// The text is classified 64 bytes at a time into bit masks of quotes,
+    /// delimiters and line breaks; a prefix XOR over the quote mask marks the
+    /// bytes inside quoted fields, whose delimiters and breaks are then
+    /// dropped. `next()` walks the remaining bits, so the cost per byte does
+    /// not depend on field width. Fields are views into the text, except for
+    /// quoted fields with doubled quotes, which are unescaped into a buffer
+    /// reused from record to record.
+    class record_scanner
+    {
+    public:
+        /// \brief Scan the text of \p src, which must outlive the scanner.
+        explicit record_scanner(const source &src, const record_options &opts = {});
+
+        /// \brief Scan \p text, whose lines end as given by \p endings.
+        explicit record_scanner(std::string_view text, const record_options &opts = {},
+                                line_ending endings = line_ending::lf);
+
+        /// \brief Advance to the next record.
+        /// \return False at the end of the text
+        bool next();
+
+        /// \return Fields of the current record, valid until the next call to `next()`
+        std::span<const std::string_view> fields() const { return views_; }
+
+        /// \return Number of fields of the current record
+        std::size_t size() const { return views_.size(); }
+
+        /// \return Field \p i of the current record
+        std::string_view operator[](std::size_t i) const { return views_[i]; }
+
+        /// \return Line (1-based) on which the current record starts
+        std::size_t line() const { return line_; }
+
+        /// \return Byte offset at which the current record starts
+        std::size_t offset() const { return offset_; }
+
+        /// \brief Convert field \p i with `std::from_chars`, ignoring surrounding blanks.
+        /// \return The value, `errc::invalid_number`, or `std::errc::result_out_of_range`
+        template <typename T>
+        result<T> to(std::size_t i) const noexcept
+        {
+            std::string_view f = views_[i];
+            while (!f.empty() && (f.front() == ' ' || f.front() == '\t'))
+                f.remove_prefix(1);
+            while (!f.empty() && (f.back() == ' ' || f.back() == '\t'))
+                f.remove_suffix(1);
+
+            T value{};
+            auto [end, ec] = std::from_chars(f.data(), f.data() + f.size(), value);
+            if (ec == std::errc::result_out_of_range)
+                return std::make_error_code(ec);
+            if (ec != std::errc() || end != f.data() + f.size())
+                return make_error_code(errc::invalid_number);
+            return value;
+        }
+
+        /// \brief Convert field \p i, throwing `std::invalid_argument` if it is not a number.
+        template <typename T>
+        T as(std::size_t i) const
+        {
+            result<T> r = to<T>(i);
+            if (!r)
+                not_a_number(i);
+            return *r;
+        }
+
+    private:
+        /// \brief Throw `std::invalid_argument` naming field \p i and its text.
+        [[noreturn]] void not_a_number(std::size_t i) const;
+
+        /// \brief A field as an offset into the text or into `scratch_`.
+        struct field
+        {
+            bool unescaped;
+            std::size_t start;
+            std::size_t length;
+        };
+
+        /// \brief Classify the 64 bytes at `block_`.
+        void load_block();
+
+        /// \brief Record the field [start, end) of the text, unquoting it.
+        void add_field(std::size_t start, std::size_t end);
+
+        const char *text_;
+        std::size_t size_;
+        record_options options_;
+        char break_char_;
+
+        std::size_t block_;         ///< Offset of the classified block
+        std::uint64_t structural_;  ///< Unconsumed separators and breaks of the block
+        std::uint64_t breaks_;      ///< The breaks among them
+        std::uint64_t inside_;      ///< 1 if the previous block ended inside quotes, else 0
+
+        std::size_t pos_;           ///< Start of the next record
+        std::size_t next_line_;     ///< Line on which it starts
+        std::size_t line_;
+        std::size_t offset_;
+        bool quoted_;               ///< The current record has a quoted field
+
+        std::vector<field> fields_;
+        std::vector<std::string_view> views_;
+        std::string scratch_;
+    };
+
+    /// \brief Reads the lines of a text backwards from its end, like `tail`.
+    ///
+    /// Each step searches backwards for the previous line break 16 bytes at
+    /// a time, so reading the last lines of a huge file touches only the
+    /// pages holding them. Lines are views into the text, without their
+    /// terminators, split as by `source::lines()`. Line numbers are not
+    /// needed to walk backwards; `line()` counts the breaks before the
+    /// position once, on first use, in parallel for large texts.
+    class reverse_cursor
+    {
+    public:
+        /// \brief Walk back through the text of \p src, which must outlive the cursor.
+        explicit reverse_cursor(const source &src);
+
+        /// \brief Walk back through \p text, whose lines end as given by \p endings.
+        explicit reverse_cursor(std::string_view text, line_ending endings = line_ending::lf);
+
+        /// \brief Step back one line.
+        /// \return The line, or nothing at the start of the text
+        std::optional<std::string_view> previous();
+
+        /// \brief Step back up to \p n lines.
+        /// \return The lines, in text order
+        std::vector<std::string_view> tail(std::size_t n);
+
+        /// \return Offset at which the line returned last starts (the text size before the first step)
+        std::size_t offset() const { return end_; }
+
+        /// \return Number (1-based) of the line starting at `offset()`
+        std::size_t line() const;
+
+    private:
+        const char *data_;
+        std::size_t size_;
+        line_ending endings_;
+        char break_char_;
+        std::size_t end_;                          ///< Start of the line returned last
+        mutable std::optional<std::size_t> line_;  ///< Its number, once counted
+    };
+
+    /// \brief Handle of a string interned in an `intern_pool`.
+    ///
+    /// Equal strings of one pool have equal handles. The default handle
+    /// stands for the empty string.
+    struct symbol
+    {
+        std::uint32_t id = 0;
+
+        friend bool operator==(symbol a, symbol b) = default;
+        friend auto operator<=>(symbol a, symbol b) = default;
+    };
+
+    /// \brief Deduplicating string store for identifiers and other tokens.
+    ///
+    /// Each distinct string is copied once, NUL-terminated, into large arena
+    /// blocks and found again through an open-addressing hash table. Views
+    /// returned by the pool stay valid until it is cleared or destroyed,
+    /// which frees all blocks at once.
+    class intern_pool
+    {
+    public:
+        intern_pool();
+
+        intern_pool(const intern_pool &) = delete;
+        intern_pool &operator=(const intern_pool &) = delete;
+        /// \brief Take the strings of \p other, leaving it empty but usable.
+        intern_pool(intern_pool &&other);
+        intern_pool &operator=(intern_pool &&other);
+
+        /// \brief Hash used by the pool (64-bit FNV-1a).
+        ///
+        /// Readers can compute it a byte at a time while scanning a token
+        /// and pass it to `intern()`, so the token is not hashed twice.
+        static constexpr std::uint64_t hash_seed = 0xcbf29ce484222325ull;
+        static constexpr std::uint64_t hash_step(std::uint64_t h, char c) noexcept
+        {
+            return (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+        }
+        static std::uint64_t hash(std::string_view text) noexcept;
+
+        /// \return Handle of \p text, copying it into the pool if it is new
+        symbol intern(std::string_view text);
+
+        /// \brief Intern \p text whose `hash()` is already known.
+        symbol intern(std::string_view text, std::uint64_t hash);
+
+        /// \return Handle of \p text if it has been interned
+        std::optional<symbol> find(std::string_view text) const;
+
+        /// \return The string of \p s (NUL-terminated)
+        std::string_view view(symbol s) const { return strings_[s.id]; }
+        std::string_view operator[](symbol s) const { return strings_[s.id]; }
+
+        /// \return Number of distinct strings, including the empty string
+        std::size_t size() const { return strings_.size(); }
+
+        /// \return Bytes of arena storage in use
+        std::size_t bytes() const { return used_; }
+
+        /// \brief Release all strings; earlier handles and views become invalid.
+        void clear();
+
+    private:
+        struct slot
+        {
+            std::uint64_t hash;
+            std::uint32_t id; ///< 0 if the slot is free (the empty string is never stored)
+        };
+
+        /// \return Slot holding \p text, or the free slot where it belongs
+        std::size_t probe(std::string_view text, std::uint64_t hash) const;
+
+        /// \brief Copy \p text into the arena.
+        const char *store(std::string_view text);
+
+        void grow();
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char *free_;
+        std::size_t left_;
+        std::size_t used_;
+        std::vector<slot> slots_;
+        std::vector<std::string_view> strings_;
+    };
+
+    /// \brief Read the next word (as `operator>>` does) into \p pool.
+    ///
+    /// The word is hashed while it is read and is not allocated unless it
+    /// is new to the pool. Returns the empty symbol at end of input.
+    symbol read_symbol(source &s, intern_pool &pool);
+
+    /// \brief Read the next word from a cursor into \p pool.
+    symbol read_symbol(cursor &c, intern_pool &pool);
+
+    /// \brief Read the next word from a source stack into \p pool.
+    symbol read_symbol(source_stack &s, intern_pool &pool);
+
+    /// \brief Read the next word from an overlay into \p pool.
+    symbol read_symbol(overlay &o, intern_pool &pool);
+
+    /// \brief Advance a location over the consumed bytes.
+    ///
+    /// Line breaks are located with a bulk search, so the cost does not depend
+    /// on a per-character branch. Breaks follow \p endings as in `line_index`;
+    /// `line_ending::detect` is treated as `line_ending::lf`.
+    location advance_location(location loc, std::string_view consumed,
+                              line_ending endings = line_ending::lf);
+
+    /// \brief A token produced by `tokenize`: a view into the source and its start.
+    struct token
+    {
+        std::string_view text;
+        location where;
+    };
+
+    /// \brief Minimal C++20 coroutine generator usable as a `std::ranges` input view.
+    ///
+    /// The yielded value is not copied: the iterator refers to the object
+    /// passed to `co_yield`, which stays alive while the coroutine is suspended.
+    /// The only allocation is the coroutine frame itself.
+    template <typename T>
+    class generator : public std::ranges::view_base
+    {
+    public:
+        struct promise_type
+        {
+            const T *value_ = nullptr;
+            std::exception_ptr error_;
+
+            generator get_return_object()
+            {
+                return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            std::suspend_always yield_value(const T &v) noexcept
+            {
+                value_ = std::addressof(v);
+                return {};
+            }
+            void return_void() noexcept {}
+            void unhandled_exception() { error_ = std::current_exception(); }
+
+            // Disallow co_await inside generators
+            template <typename U>
+            std::suspend_never await_transform(U &&) = delete;
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        class iterator
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            explicit iterator(handle_type h) : handle_(h) {}
+
+            const T &operator*() const { return *handle_.promise().value_; }
+            const T *operator->() const { return handle_.promise().value_; }
+
+            iterator &operator++()
+            {
+                handle_.resume();
+                if (handle_.done() && handle_.promise().error_)
+                    std::rethrow_exception(handle_.promise().error_);
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const iterator &it, std::default_sentinel_t)
+            {
+                return !it.handle_ || it.handle_.done();
+            }
+
+        private:
+            handle_type handle_;
+        };
+
+        generator() = default;
+        generator(generator &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+        generator &operator=(generator &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                    handle_.destroy();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+        generator(const generator &) = delete;
+        generator &operator=(const generator &) = delete;
+        ~generator()
+        {
+            if (handle_)
+                handle_.destroy();
+        }
+
+        /// \brief Start (or continue) the coroutine and return an iterator to the current value.
+        iterator begin()
+        {
+            if (handle_ && !handle_.done())
+            {
+                handle_.resume();
+                if (handle_.done() && handle_.promise().error_)
+                    std::rethrow_exception(handle_.promise().error_);
+            }
+            return iterator(handle_);
+        }
+
+        std::default_sentinel_t end() const noexcept { return {}; }
+
+    private:
+        explicit generator(handle_type h) : handle_(h) {}
+        handle_type handle_;
+    };
+
+    /// \brief Requirements for pluggable tokenizer rules.
+    ///
+    /// `skip(rest)` returns the number of bytes to discard before the next
+    /// token; `match(rest)` returns the length of the token starting at
+    /// `rest` (a zero result is treated as a one-byte token).
+    template <typename R>
+    concept token_rules = requires(const R &r, std::string_view rest) {
+        { r.skip(rest) } -> std::convertible_to<std::size_t>;
+        { r.match(rest) } -> std::convertible_to<std::size_t>;
+    };
+
+    /// \brief Default rules: whitespace-separated words, as `operator>>` reads them.
+    struct word_rules
+    {
+        std::size_t skip(std::string_view rest) const
+        {
+            std::size_t n = 0;
+            while (n < rest.size() && std::isspace(static_cast<unsigned char>(rest[n])))
+                ++n;
+            return n;
+        }
+
+        std::size_t match(std::string_view rest) const
+        {
+            std::size_t n = 0;
+            while (n < rest.size() && !std::isspace(static_cast<unsigned char>(rest[n])))
+                ++n;
+            return n;
+        }
+    };
+
+    /// \brief Lazily split \p text into tokens according to \p rules.
+    ///
+    /// Tokens are views into \p text, so the underlying buffer must outlive
+    /// the generator. \p start gives the location of the first byte of \p text
+    /// and \p endings decides which bytes break lines.
+    template <token_rules Rules = word_rules>
+    generator<token> tokenize(std::string_view text, location start = {}, Rules rules = {},
+                              line_ending endings = line_ending::lf)
+    {
+        if (endings == line_ending::detect)
+            endings = detect_line_ending(text.data(), text.size());
+        location loc = start;
+        std::string_view rest = text;
+        while (!rest.empty())
+        {
+            std::size_t gap = rules.skip(rest);
+            if (gap > rest.size())
+                gap = rest.size();
+            loc = advance_location(loc, rest.substr(0, gap), endings);
+            rest.remove_prefix(gap);
+            if (rest.empty())
+                break;
+
+            std::size_t len = rules.match(rest);
+            if (len == 0)
+                len = 1;
+            if (len > rest.size())
+                len = rest.size();
+
+            token t{rest.substr(0, len), loc};
+            co_yield t;
+
+            loc = advance_location(loc, t.text, endings);
+            rest.remove_prefix(len);
+        }
+    }
+
+    /// \brief Tokenize a whole mapped source.
+    template <token_rules Rules = word_rules>
+    generator<token> tokenize(const mapped_source &src, Rules rules = {})
+    {
+        return tokenize(std::string_view(src.data(), src.size()), location{}, rules, src.endings());
+    }
+
+    /// \brief Tokenize the remainder of a mapped source, starting at the cursor.
+    ///
+    /// The cursor itself is not advanced.
+    template <token_rules Rules = word_rules>
+    generator<token> tokenize(const cursor &c, Rules rules = {})
+    {
+        std::string_view all(c.data(), c.size());
+        location start{c.position(),
+                       static_cast<std::uint32_t>(c.line()),
+                       static_cast<std::uint32_t>(c.column())};
+        return tokenize(all.substr(c.position()), start, rules, c.endings());
+    }
+
+    /// \brief Tokenize the remainder of a source, starting at its current position.
+    ///
+    /// The source itself is not advanced.
+    template <token_rules Rules = word_rules>
+    generator<token> tokenize(const source &s, Rules rules = {})
+    {
+        std::string_view all(s.data(), s.size());
+        location start{s.position(),
+                       static_cast<std::uint32_t>(s.line()),
+                       static_cast<std::uint32_t>(s.column())};
+        return tokenize(all.substr(s.position()), start, rules, s.endings());
+    }
+
+    /// \brief Runs a tokenizer on a producer thread and hands tokens over in batches.
+    ///
+    /// At most \p depth batches of \p batch_size tokens are in flight, so the
+    /// producer blocks when the consumer falls behind. Batch vectors are
+    /// recycled between producer and consumer, so no allocation happens per
+    /// token or per batch once the pipeline is running. An exception thrown
+    /// by the tokenizer is rethrown from `next()` after the tokens produced
+    /// before it.
+    ///
+    /// The producer thread reads the text for as long as the pipeline runs,
+    /// and the delivered tokens are views into it.
+    class token_pipeline
+    {
+    public:
+        /// \brief Start tokenizing \p text, which must outlive the pipeline and its tokens.
+        template <token_rules Rules = word_rules>
+        explicit token_pipeline(std::string_view text,
+                                std::size_t batch_size = 4096,
+                                std::size_t depth = 4,
+                                Rules rules = {},
+                                line_ending endings = line_ending::lf)
+            : batch_size_(batch_size ? batch_size : 1), depth_(depth ? depth : 1)
+        {
+            prepare();
+            worker_ = std::thread([this, text, rules, endings]
+                                  {
+                std::vector<token> batch;
+                try
+                {
+                    if (!acquire(batch))
+                        return;
+                    for (const token &t : tokenize(text, location{}, rules, endings))
+                    {
+                        batch.push_back(t);
+                        if (batch.size() == batch_size_ && !publish(batch))
+                            return;
+                    }
+                    finish(batch);
+                }
+                catch (...)
+                {
+                    finish(batch, std::current_exception());
+                } });
+        }
+
+        ~token_pipeline();
+
+        token_pipeline(const token_pipeline &) = delete;
+        token_pipeline &operator=(const token_pipeline &) = delete;
+
+        /// \brief Receive the next batch of tokens, blocking until one is ready.
+        ///
+        /// The previous contents of \p batch are recycled.
+        /// \return False once all tokens have been delivered
+        /// \throws Whatever the tokenizer threw, once the batches before it are delivered
+        bool next(std::vector<token> &batch);
+
+    private:
+        void prepare();
+        /// \return False if the pipeline is stopping; otherwise \p batch is an empty free batch
+        bool acquire(std::vector<token> &batch);
+        bool publish(std::vector<token> &batch);
+        /// \brief Publish the partly filled \p last batch and signal the end, or \p error.
+        void finish(std::vector<token> &last, std::exception_ptr error = nullptr);
+
+        std::size_t batch_size_;
+        std::size_t depth_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::condition_variable space_;
+        std::deque<std::vector<token>> full_;
+        std::vector<std::vector<token>> free_;
+        bool done_ = false;
+        bool stopping_ = false;
+        std::exception_ptr error_;
+        std::thread worker_;
+    };
+
+    /// \brief Set of byte values, usable in constant expressions.
+    class charset
+    {
+    public:
+        constexpr charset() = default;
+
+        /// \brief Set containing the single byte \p c.
+        constexpr charset(char c) { add(static_cast<unsigned char>(c)); }
+
+        /// \return Set of all bytes in the inclusive range [lo, hi]
+        static constexpr charset range(char lo, char hi)
+        {
+            charset s;
+            for (unsigned c = static_cast<unsigned char>(lo); c <= static_cast<unsigned char>(hi); ++c)
+                s.add(c);
+            return s;
+        }
+
+        /// \return Set of the bytes in \p chars
+        static constexpr charset of(std::string_view chars)
+        {
+            charset s;
+            for (char c : chars)
+                s.add(static_cast<unsigned char>(c));
+            return s;
+        }
+
+        /// \return Set of all 256 byte values
+        static constexpr charset any() { return ~charset(); }
+
+        static constexpr charset digit() { return range('0', '9'); }
+        static constexpr charset hex_digit() { return digit() | range('a', 'f') | range('A', 'F'); }
+        static constexpr charset alpha() { return range('a', 'z') | range('A', 'Z'); }
+        static constexpr charset alnum() { return alpha() | digit(); }
+        static constexpr charset space() { return of(" \t\n\r\f\v"); }
+
+        constexpr bool contains(unsigned char c) const
+        {
+            return (bits_[c >> 6] >> (c & 63)) & 1;
+        }
+
+        constexpr bool empty() const
+        {
+            return (bits_[0] | bits_[1] | bits_[2] | bits_[3]) == 0;
+        }
+
+        constexpr charset operator|(const charset &o) const
+        {
+            charset s;
+            for (int i = 0; i < 4; ++i)
+                s.bits_[i] = bits_[i] | o.bits_[i];
+            return s;
+        }
+
+        constexpr charset operator&(const charset &o) const
+        {
+            charset s;
+            for (int i = 0; i < 4; ++i)
+                s.bits_[i] = bits_[i] & o.bits_[i];
+            return s;
+        }
+
+        constexpr charset operator~() const
+        {
+            charset s;
+            for (int i = 0; i < 4; ++i)
+                s.bits_[i] = ~bits_[i];
+            return s;
+        }
+
+        /// \return Bytes in this set but not in \p o
+        constexpr charset operator-(const charset &o) const { return *this & ~o; }
+
+    private:
+        constexpr void add(unsigned c) { bits_[c >> 6] |= std::uint64_t{1} << (c & 63); }
+
+        std::uint64_t bits_[4]{};
+    };
+
+    /// \brief Reserved token ids reported by `dfa_lexer`.
+    namespace lex
+    {
+        inline constexpr std::uint16_t end = 0;      ///< End of input
+        inline constexpr std::uint16_t skip = 0xFFFE; ///< Matched text that is not reported
+        inline constexpr std::uint16_t error = 0xFFFF; ///< Byte that starts no token
+    }
+
+    /// \brief Declarative token rules, built in constant expressions.
+    ///
+    /// Each rule adds a small NFA fragment hanging off a shared start state.
+    /// `make_dfa` turns the combined NFA into a transition table at compile
+    /// time. When several rules match the same longest text, the rule added
+    /// first wins. Token ids must be in [1, 0xFFFD].
+    ///
+    /// \tparam MaxStates Capacity for NFA states
+    /// \tparam MaxEdges  Capacity for NFA transitions
+    template <std::size_t MaxStates = 128, std::size_t MaxEdges = 256>
+    class lexer_spec
+    {
+    public:
+        struct edge
+        {
+            std::uint16_t from = 0;
+            std::uint16_t to = 0;
+            charset on;
+        };
+
+        constexpr lexer_spec() { new_state(); }
+
+        /// \brief Discard runs of bytes from \p ws between tokens.
+        constexpr lexer_spec &skip(charset ws)
+        {
+            std::uint16_t a = new_state();
+            add_edge(0, a, ws);
+            add_edge(a, a, ws);
+            accept(a, lex::skip);
+            return *this;
+        }
+
+        /// \brief Match the exact text \p text (operators, punctuation).
+        constexpr lexer_spec &literal(std::uint16_t id, std::string_view text)
+        {
+            if (text.empty())
+                throw std::logic_error("lexer_spec: empty literal");
+            std::uint16_t s = 0;
+            for (char c : text)
+            {
+                std::uint16_t t = new_state();
+                add_edge(s, t, c);
+                s = t;
+            }
+            accept(s, id);
+            return *this;
+        }
+
+        /// \brief Match one byte from \p first followed by any number from \p rest.
+        constexpr lexer_spec &identifier(std::uint16_t id,
+                                         charset first = charset::alpha() | '_',
+                                         charset rest = charset::alnum() | '_')
+        {
+            std::uint16_t a = new_state();
+            add_edge(0, a, first);
+            add_edge(a, a, rest);
+            accept(a, id);
+            return *this;
+        }
+
+        /// \brief Match decimal integers and reals with optional exponent, and 0x hex integers.
+        constexpr lexer_spec &number(std::uint16_t id)
+        {
+            const charset digit = charset::digit();
+            const charset exp = charset::of("eE");
+
+            std::uint16_t intg = new_state();
+            std::uint16_t dot = new_state();
+            std::uint16_t frac = new_state();
+            std::uint16_t e = new_state();
+            std::uint16_t sign = new_state();
+            std::uint16_t expd = new_state();
+            add_edge(0, intg, digit);
+            add_edge(intg, intg, digit);
+            add_edge(intg, dot, '.');
+            add_edge(dot, frac, digit);
+            add_edge(frac, frac, digit);
+            add_edge(intg, e, exp);
+            add_edge(frac, e, exp);
+            add_edge(e, sign, charset::of("+-"));
+            add_edge(e, expd, digit);
+            add_edge(sign, expd, digit);
+            add_edge(expd, expd, digit);
+            accept(intg, id);
+            accept(frac, id);
+            accept(expd, id);
+
+            std::uint16_t zero = new_state();
+            std::uint16_t x = new_state();
+            std::uint16_t hex = new_state();
+            add_edge(0, zero, '0');
+            add_edge(zero, x, charset::of("xX"));
+            add_edge(x, hex, charset::hex_digit());
+            add_edge(hex, hex, charset::hex_digit());
+            accept(hex, id);
+            return *this;
+        }
+
+        /// \brief Match text between \p quote bytes, with \p escape protecting the next byte.
+        ///
+        /// Quoted text may not span lines.
+        constexpr lexer_spec &quoted(std::uint16_t id, char quote, char escape = '\\')
+        {
+            std::uint16_t body = new_state();
+            std::uint16_t esc = new_state();
+            std::uint16_t done = new_state();
+            add_edge(0, body, quote);
+            add_edge(body, body, charset::any() - (charset(quote) | charset(escape) | charset('\n')));
+            add_edge(body, esc, escape);
+            add_edge(esc, body, charset::any());
+            add_edge(body, done, quote);
+            accept(done, id);
+            return *this;
+        }
+
+        /// \brief Discard text from \p prefix to the end of the line.
+        constexpr lexer_spec &line_comment(std::string_view prefix)
+        {
+            std::uint16_t s = chain(prefix);
+            add_edge(s, s, charset::any() - '\n');
+            accept(s, lex::skip);
+            return *this;
+        }
+
+        /// \brief Discard text from \p open to the first following \p close.
+        ///
+        /// \p close must be two bytes long with distinct bytes (as in C's "*" "/").
+        constexpr lexer_spec &block_comment(std::string_view open, std::string_view close)
+        {
+            if (close.size() != 2 || close[0] == close[1])
+                throw std::logic_error("lexer_spec: block comment close must be two distinct bytes");
+
+            std::uint16_t body = chain(open);
+            std::uint16_t star = new_state();
+            std::uint16_t done = new_state();
+            add_edge(body, body, charset::any() - close[0]);
+            add_edge(body, star, close[0]);
+            add_edge(star, star, close[0]);
+            add_edge(star, body, charset::any() - (charset(close[0]) | charset(close[1])));
+            add_edge(star, done, close[1]);
+            accept(done, lex::skip);
+            return *this;
+        }
+
+        constexpr std::size_t state_count() const { return states_; }
+        constexpr std::size_t edge_count() const { return edges_; }
+        constexpr const edge &edge_at(std::size_t i) const { return edge_list_[i]; }
+        constexpr std::uint16_t accept_id(std::size_t s) const { return accept_id_[s]; }
+        constexpr std::uint16_t accept_rank(std::size_t s) const { return accept_rank_[s]; }
+
+    private:
+        constexpr std::uint16_t new_state()
+        {
+            if (states_ >= MaxStates)
+                throw std::logic_error("lexer_spec: too many states");
+            accept_id_[states_] = 0;
+            accept_rank_[states_] = 0;
+            return static_cast<std::uint16_t>(states_++);
+        }
+
+        constexpr void add_edge(std::uint16_t from, std::uint16_t to, charset on)
+        {
+            if (edges_ >= MaxEdges)
+                throw std::logic_error("lexer_spec: too many edges");
+            edge_list_[edges_++] = edge{from, to, on};
+        }
+
+        constexpr std::uint16_t chain(std::string_view text)
+        {
+            std::uint16_t s = 0;
+            for (char c : text)
+            {
+                std::uint16_t t = new_state();
+                add_edge(s, t, c);
+                s = t;
+            }
+            return s;
+        }
+
+        constexpr void accept(std::uint16_t state, std::uint16_t id)
+        {
+            if (id == lex::end || id == lex::error)
+                throw std::logic_error("lexer_spec: reserved token id");
+            accept_id_[state] = id;
+            accept_rank_[state] = ++rules_;
+        }
+
+        std::size_t states_ = 0;
+        std::size_t edges_ = 0;
+        std::uint16_t rules_ = 0;
+        std::array<edge, MaxEdges> edge_list_{};
+        std::array<std::uint16_t, MaxStates> accept_id_{};
+        std::array<std::uint16_t, MaxStates> accept_rank_{};
+    };
+
+    /// \brief Non-owning view of a DFA transition table.
+    ///
+    /// State 0 is the dead state and state 1 the start state. The next state
+    /// is `next[state * class_count + classes[byte]]`; `accept[state]` is the
+    /// token id recognised in that state, or 0.
+    struct dfa_view
+    {
+        const std::uint8_t *classes = nullptr;
+        const std::uint16_t *next = nullptr;
+        const std::uint16_t *accept = nullptr;
+        std::size_t class_count = 0;
+    };
+
+    /// \brief DFA transition table produced by `make_dfa`.
+    template <std::size_t MaxStates, std::size_t MaxClasses>
+    struct dfa_table
+    {
+        std::array<std::uint8_t, 256> classes{};
+        std::array<std::uint16_t, MaxStates * MaxClasses> next{};
+        std::array<std::uint16_t, MaxStates> accept{};
+        std::size_t class_count = 0;
+        std::size_t state_count = 0;
+
+        constexpr dfa_view view() const
+        {
+            return dfa_view{classes.data(), next.data(), accept.data(), class_count};
+        }
+    };
+
+    /// \brief Compile a `lexer_spec` into a DFA by subset construction.
+    ///
+    /// Bytes that no rule distinguishes share an equivalence class, which
+    /// keeps the table small: each row has one entry per class, not per byte.
+    /// Intended to be evaluated at compile time, e.g.
+    /// `static constexpr auto table = mms::make_dfa(spec);`
+    template <std::size_t MaxStates = 256, std::size_t MaxClasses = 64,
+              std::size_t N, std::size_t E>
+    constexpr dfa_table<MaxStates, MaxClasses> make_dfa(const lexer_spec<N, E> &spec)
+    {
+        constexpr std::size_t words = (N + 63) / 64;
+        using nfa_set = std::array<std::uint64_t, words>;
+
+        dfa_table<MaxStates, MaxClasses> t;
+
+        // 1. Byte equivalence classes: refine by every edge's charset
+        std::size_t classes = 1;
+        for (std::size_t e = 0; e < spec.edge_count(); ++e)
+        {
+            const charset &on = spec.edge_at(e).on;
+            std::array<int, MaxClasses> split{};
+            for (std::size_t k = 0; k < MaxClasses; ++k)
+                split[k] = -1;
+            std::array<bool, MaxClasses> has_out{};
+            for (unsigned c = 0; c < 256; ++c)
+                if (!on.contains(static_cast<unsigned char>(c)))
+                    has_out[t.classes[c]] = true;
+            for (unsigned c = 0; c < 256; ++c)
+            {
+                std::uint8_t k = t.classes[c];
+                if (!on.contains(static_cast<unsigned char>(c)) || !has_out[k])
+                    continue;
+                if (split[k] < 0)
+                {
+                    if (classes >= MaxClasses)
+                        throw std::logic_error("make_dfa: too many byte classes");
+                    split[k] = static_cast<int>(classes++);
+                }
+                t.classes[c] = static_cast<std::uint8_t>(split[k]);
+            }
+        }
+        t.class_count = classes;
+
+        std::array<unsigned char, MaxClasses> representative{};
+        for (int c = 255; c >= 0; --c)
+            representative[t.classes[c]] = static_cast<unsigned char>(c);
+
+        // 2. Subset construction
+        std::array<nfa_set, MaxStates> sets{};
+        std::size_t count = 2; // 0 = dead, 1 = start
+        sets[1][0] = 1;        // NFA state 0
+
+        for (std::size_t d = 1; d < count; ++d)
+        {
+            // Accepting rule with the best (lowest) rank
+            std::uint16_t best_rank = 0;
+            for (std::size_t s = 0; s < spec.state_count(); ++s)
+                if ((sets[d][s / 64] >> (s % 64)) & 1)
+                {
+                    std::uint16_t r = spec.accept_rank(s);
+                    if (r && (!best_rank || r < best_rank))
+                    {
+                        best_rank = r;
+                        t.accept[d] = spec.accept_id(s);
+                    }
+                }
+
+            for (std::size_t k = 0; k < classes; ++k)
+            {
+                unsigned char c = representative[k];
+                nfa_set target{};
+                bool any = false;
+                for (std::size_t e = 0; e < spec.edge_count(); ++e)
+                {
+                    const auto &ed = spec.edge_at(e);
+                    if (((sets[d][ed.from / 64] >> (ed.from % 64)) & 1) && ed.on.contains(c))
+                    {
+                        target[ed.to / 64] |= std::uint64_t{1} << (ed.to % 64);
+                        any = true;
+                    }
+                }
+                if (!any)
+                    continue; // stays 0: dead
+
+                std::size_t found = 0;
+                for (std::size_t x = 1; x < count && !found; ++x)
+                    if (sets[x] == target)
+                        found = x;
+                if (!found)
+                {
+                    if (count >= MaxStates)
+                        throw std::logic_error("make_dfa: too many DFA states");
+                    sets[count] = target;
+                    found = count++;
+                }
+                t.next[d * MaxClasses + k] = static_cast<std::uint16_t>(found);
+            }
+        }
+        t.state_count = count;
+
+        // Compact rows from MaxClasses to class_count entries
+        for (std::size_t d = 0; d < count; ++d)
+            for (std::size_t k = 0; k < classes; ++k)
+                t.next[d * classes + k] = t.next[d * MaxClasses + k];
+
+        return t;
+    }
+
+    /// \brief Keyword and its token id, as stored in a `keyword_table` slot.
+    struct keyword_entry
+    {
+        std::string_view text;
+        std::uint16_t id = 0;
+    };
+
+    /// \brief Non-owning view of a `keyword_table`, independent of its size.
+    struct keyword_view
+    {
+        const keyword_entry *slots = nullptr;
+        std::size_t mask = 0;
+        std::uint32_t seed = 0;
+
+        /// \return Keyword id of \p text, or 0 if it is not a keyword
+        constexpr std::uint16_t find(std::string_view text) const
+        {
+            const keyword_entry &e = slots[hash(text, seed) & mask];
+            return e.text == text ? e.id : 0;
+        }
+
+        static constexpr std::uint32_t hash(std::string_view s, std::uint32_t seed)
+        {
+            std::uint32_t h = seed ^ static_cast<std::uint32_t>(s.size() * 0x9E3779B1u);
+            for (char c : s)
+                h = (h ^ static_cast<unsigned char>(c)) * 0x01000193u;
+            return h ^ (h >> 15);
+        }
+    };
+
+    /// \brief Keyword lookup table with a perfect hash found at compile time.
+    ///
+    /// \tparam Slots Table size; a power of two larger than the keyword count
+    template <std::size_t Slots>
+    class keyword_table
+    {
+        static_assert((Slots & (Slots - 1)) == 0, "keyword_table size must be a power of two");
+
+    public:
+        using entry = keyword_entry;
+
+        /// \brief Build the table, searching for a collision-free hash seed.
+        constexpr keyword_table(std::initializer_list<entry> keywords)
+        {
+            if (keywords.size() >= Slots)
+                throw std::logic_error("keyword_table: too many keywords");
+
+            for (seed_ = 1; seed_ < 100000; ++seed_)
+            {
+                slots_ = {};
+                bool ok = true;
+                for (const entry &k : keywords)
+                {
+                    std::size_t i = hash(k.text, seed_) & (Slots - 1);
+                    if (slots_[i].id != 0)
+                    {
+                        ok = false;
+                        break;
+                    }
+                    slots_[i] = k;
+                }
+                if (ok)
+                    return;
+            }
+            throw std::logic_error("keyword_table: no perfect hash found; use more slots");
+        }
+
+        /// \return Keyword id of \p text, or 0 if it is not a keyword
+        constexpr std::uint16_t find(std::string_view text) const
+        {
+            return view().find(text);
+        }
+
+        /// \return Hash seed found for this keyword set
+        constexpr std::uint32_t seed() const { return seed_; }
+
+        constexpr keyword_view view() const
+        {
+            return keyword_view{slots_.data(), Slots - 1, seed_};
+        }
+
+        static constexpr std::uint32_t hash(std::string_view s, std::uint32_t seed)
+        {
+            return keyword_view::hash(s, seed);
+        }
+
+    private:
+        std::array<entry, Slots> slots_{};
+        std::uint32_t seed_ = 0;
+    };
+
+    /// \brief A token recognised by `dfa_lexer`.
+    struct lexeme
+    {
+        std::uint16_t id = lex::end;
+        std::string_view text;
+        location where;
+    };
+
+    /// \brief Table-driven lexer running directly over mapped text.
+    ///
+    /// The inner loop is one table lookup per byte with no per-character
+    /// branching on character kind; line and column are computed only at
+    /// token boundaries. Identifier-like tokens can be re-labelled through a
+    /// keyword table.
+    class dfa_lexer
+    {
+    public:
+        /// \brief Lex \p text, whose first byte is at location \p start.
+        ///
+        /// \p endings decides which bytes break lines in reported locations.
+        dfa_lexer(const dfa_view &table, std::string_view text, location start = {},
+                  line_ending endings = line_ending::lf);
+
+        /// \brief Lex the remainder of \p s, starting at its current position.
+        dfa_lexer(const dfa_view &table, const source &s);
+
+        /// \brief Re-label tokens with id \p from whose text is a keyword.
+        ///
+        /// Only a view of \p keywords is kept, so the table must outlive the
+        /// lexer; a `static constexpr` table is the usual choice.
+        template <std::size_t Slots>
+        void use_keywords(const keyword_table<Slots> &keywords, std::uint16_t from)
+        {
+            keywords_ = keywords.view();
+            keyword_source_ = from;
+        }
+
+        /// A temporary table would dangle.
+        template <std::size_t Slots>
+        void use_keywords(const keyword_table<Slots> &&, std::uint16_t) = delete;
+
+        /// \brief Return the next token; `lex::end` at the end of input.
+        lexeme next();
+
+        /// \return Location of the next unread byte
+        location where() const;
+
+    private:
+        dfa_view table_;
+        const char *pos_;
+        const char *end_;
+        location loc_;
+        line_ending endings_;
+        keyword_view keywords_;
+        std::uint16_t keyword_source_ = lex::end;
+    };
+
+} // namespace mms
+
+/// Iterators of a `line_range` refer to the line index, not to the range itself.
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<mms::line_range> = true;
+
+/// `mms::errc` values convert to and compare with `std::error_code`.
+template <>
+struct std::is_error_code_enum<mms::errc> : std::true_type
+{
+};
+
+/// Symbols hash by their id, so they can key unordered containers directly.
+template <>
+struct std::hash<mms::symbol>
+{
+    std::size_t operator()(mms::symbol s) const noexcept { return s.id; }
+};
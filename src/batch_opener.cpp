@@ -0,0 +1,476 @@
+/// \file
+/// \brief Implementation of the `mms::batch_opener` class.
+///
+/// Opening a file costs three blocking system calls (open, size query,
+/// mmap), so opening thousands of small files one at a time is bound by
+/// syscall latency. With io_uring the opens and `statx` size queries for
+/// a whole window of files are submitted together, and a readahead hint
+/// follows each successful open. The ring is used directly through the
+/// kernel interface, without liburing. Where io_uring is missing, a pool
+/// of worker threads overlaps the blocking calls instead.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define MMS_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/stat.h>    // statx
+#include <sys/syscall.h> // __NR_io_uring_*
+#endif
+
+#include <fcntl.h>    // AT_FDCWD, O_RDONLY
+#include <unistd.h>   // close, syscall
+#include <sys/mman.h> // mmap, munmap
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+#if defined(MMS_HAVE_IO_URING)
+
+    namespace
+    {
+        /// Smallest file worth a separate readahead request
+        constexpr std::uint64_t readahead_min = 64 * 1024;
+    }
+
+    /// \brief A minimal io_uring: submission and completion rings plus per-file state.
+    struct batch_opener::ring
+    {
+        enum op : std::uint64_t
+        {
+            op_open = 0,
+            op_statx = 1,
+            op_advise = 2
+        };
+
+        struct slot
+        {
+            int fd = -1;
+            int open_result = 0;
+            int statx_result = 0;
+            unsigned pending = 0;
+            struct statx stx{};
+        };
+
+        int fd = -1;
+        unsigned sq_entries = 0;
+        void *sq_ptr = nullptr;
+        void *cq_ptr = nullptr;
+        std::size_t sq_size = 0;
+        std::size_t cq_size = 0;
+        io_uring_sqe *sqes = nullptr;
+        std::size_t sqes_size = 0;
+
+        unsigned *sq_head = nullptr, *sq_tail = nullptr, *sq_mask = nullptr, *sq_array = nullptr;
+        unsigned *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+        io_uring_cqe *cqes = nullptr;
+
+        unsigned to_submit = 0;
+        /// Submitted operations whose completions have not been reaped
+        unsigned in_flight = 0;
+
+        std::vector<slot> slots;
+        /// Next path to submit
+        std::size_t next_path = 0;
+        /// Files submitted but not yet returned
+        std::size_t active = 0;
+
+        ~ring()
+        {
+            if (sqes)
+                munmap(sqes, sqes_size);
+            if (cq_ptr && cq_ptr != sq_ptr)
+                munmap(cq_ptr, cq_size);
+            if (sq_ptr)
+                munmap(sq_ptr, sq_size);
+            if (fd != -1)
+                close(fd);
+        }
+
+        /// \brief Create the ring. Returns false if io_uring is not available.
+        bool setup(unsigned entries)
+        {
+            io_uring_params p{};
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+            if (fd < 0)
+            {
+                fd = -1;
+                return false;
+            }
+
+            sq_entries = p.sq_entries;
+            sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            if (p.features & IORING_FEAT_SINGLE_MMAP)
+                sq_size = cq_size = std::max(sq_size, cq_size);
+
+            sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq_ptr == MAP_FAILED)
+            {
+                sq_ptr = nullptr;
+                return false;
+            }
+            if (p.features & IORING_FEAT_SINGLE_MMAP)
+                cq_ptr = sq_ptr;
+            else
+            {
+                cq_ptr = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cq_ptr == MAP_FAILED)
+                {
+                    cq_ptr = nullptr;
+                    return false;
+                }
+            }
+            sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+            void *s = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (s == MAP_FAILED)
+                return false;
+            sqes = static_cast<io_uring_sqe *>(s);
+
+            auto *sq = static_cast<char *>(sq_ptr);
+            auto *cq = static_cast<char *>(cq_ptr);
+            sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+            sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+            sq_mask = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+            cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+            cq_mask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+            return true;
+        }
+
+        /// \brief Queue one submission entry; returns false if the ring is full.
+        io_uring_sqe *get_sqe()
+        {
+            unsigned head = std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire);
+            unsigned tail = *sq_tail;
+            if (tail - head >= sq_entries)
+                return nullptr;
+            unsigned index = tail & *sq_mask;
+            io_uring_sqe *sqe = &sqes[index];
+            *sqe = io_uring_sqe{};
+            sq_array[index] = index;
+            std::atomic_ref<unsigned>(*sq_tail).store(tail + 1, std::memory_order_release);
+            ++to_submit;
+            ++in_flight;
+            return sqe;
+        }
+
+        /// \brief Submit queued entries and wait for at least \p wait completions.
+        bool enter(unsigned wait)
+        {
+            for (;;)
+            {
+                long r = syscall(__NR_io_uring_enter, fd, to_submit, wait,
+                                 wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+                if (r >= 0)
+                {
+                    to_submit -= std::min<unsigned>(static_cast<unsigned>(r), to_submit);
+                    return true;
+                }
+                if (errno != EINTR)
+                    return false;
+            }
+        }
+
+        static std::uint64_t tag(std::size_t index, op kind)
+        {
+            return (static_cast<std::uint64_t>(index) << 2) | kind;
+        }
+
+        /// \brief Queue open and statx for path \p index.
+        bool submit_open(std::size_t index, const std::string &path)
+        {
+            if (sq_entries - (*sq_tail - std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire)) < 2)
+                return false;
+
+            io_uring_sqe *sqe = get_sqe();
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<std::uint64_t>(path.c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            sqe->user_data = tag(index, op_open);
+
+            sqe = get_sqe();
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<std::uint64_t>(path.c_str());
+            sqe->len = STATX_SIZE;
+            sqe->off = reinterpret_cast<std::uint64_t>(&slots[index].stx);
+            sqe->user_data = tag(index, op_statx);
+
+            slots[index].pending = 2;
+            return true;
+        }
+
+        /// \brief Queue a readahead hint for the opened file at \p index.
+        bool submit_advise(std::size_t index)
+        {
+            io_uring_sqe *sqe = get_sqe();
+            if (!sqe)
+                return false;
+            sqe->opcode = IORING_OP_FADVISE;
+            sqe->fd = slots[index].fd;
+            sqe->off = 0;
+            sqe->len = 0; // whole file
+            sqe->fadvise_advice = POSIX_FADV_WILLNEED;
+            sqe->user_data = tag(index, op_advise);
+            slots[index].pending = 1;
+            return true;
+        }
+    };
+
+#else
+
+    struct batch_opener::ring
+    {
+    };
+
+#endif
+
+    batch_opener::batch_opener(std::vector<std::string> paths, const batch_options &opts)
+        : paths_(std::move(paths)), opts_(opts), delivered_(0),
+          next_path_(0), stop_(false)
+    {
+        if (opts_.queue_depth == 0)
+            opts_.queue_depth = 1;
+
+#if defined(MMS_HAVE_IO_URING)
+        if (opts_.use_io_uring && !paths_.empty())
+        {
+            // Two entries per file (open + statx); the readahead reuses them
+            unsigned entries = 1;
+            while (entries < 2 * opts_.queue_depth)
+                entries <<= 1;
+            auto r = std::make_unique<ring>();
+            if (r->setup(entries))
+            {
+                r->slots.resize(paths_.size());
+                ring_ = std::move(r);
+                return;
+            }
+        }
+#endif
+
+        unsigned threads = opts_.threads ? opts_.threads : std::thread::hardware_concurrency();
+        threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(paths_.size())));
+        for (unsigned i = 0; i < threads && !paths_.empty(); ++i)
+            workers_.emplace_back([this]
+                                  { work(); });
+    }
+
+    batch_opener::~batch_opener()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        space_cv_.notify_all();
+        for (auto &t : workers_)
+            t.join();
+
+#if defined(MMS_HAVE_IO_URING)
+        if (ring_)
+        {
+            // Buffers handed to the kernel must outlive the operations
+            while (ring_->in_flight > 0)
+            {
+                if (!ring_->enter(1))
+                    break;
+                unsigned head = *ring_->cq_head;
+                unsigned tail = std::atomic_ref<unsigned>(*ring_->cq_tail).load(std::memory_order_acquire);
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe &cqe = ring_->cqes[head & *ring_->cq_mask];
+                    std::size_t index = cqe.user_data >> 2;
+                    if ((cqe.user_data & 3) == ring::op_open && cqe.res >= 0)
+                        ring_->slots[index].fd = cqe.res;
+                    --ring_->in_flight;
+                }
+                std::atomic_ref<unsigned>(*ring_->cq_head).store(head, std::memory_order_release);
+            }
+            for (auto &slot : ring_->slots)
+                if (slot.fd != -1)
+                    close(slot.fd);
+        }
+#endif
+    }
+
+    std::optional<opened_source> batch_opener::next()
+    {
+        if (delivered_ >= paths_.size())
+            return std::nullopt;
+
+#if defined(MMS_HAVE_IO_URING)
+        if (ring_)
+        {
+            ring &r = *ring_;
+
+            // Open with the ordinary constructor, capturing its exception
+            auto open_directly = [&](std::size_t index) -> opened_source
+            {
+                opened_source out{index, nullptr, nullptr};
+                try
+                {
+                    out.src = std::make_unique<source>(paths_[index].c_str(), opts_.endings, opts_.enc);
+                }
+                catch (...)
+                {
+                    out.error = std::current_exception();
+                }
+                return out;
+            };
+
+            // Build the source from the descriptor and size the kernel returned
+            auto finish = [&](std::size_t index) -> opened_source
+            {
+                ring::slot &slot = r.slots[index];
+                opened_source out{index, nullptr, nullptr};
+                int fd = std::exchange(slot.fd, -1);
+                try
+                {
+                    out.src = std::make_unique<source>(file(fd, slot.stx.stx_size, paths_[index]), opts_.endings, opts_.enc);
+                }
+                catch (...)
+                {
+                    out.error = std::current_exception();
+                }
+                return out;
+            };
+
+            // Completed files are queued in ready_; the ring runs on this
+            // thread only, so no locking is needed
+            while (ready_.empty())
+            {
+                // Keep the window full
+                while (r.next_path < paths_.size() && r.active < opts_.queue_depth &&
+                       r.submit_open(r.next_path, paths_[r.next_path]))
+                {
+                    ++r.next_path;
+                    ++r.active;
+                }
+
+                if (!r.enter(1))
+                    throw std::ios_base::failure("Error waiting for io_uring: " + std::string(strerror(errno)));
+
+                unsigned head = *r.cq_head;
+                unsigned tail = std::atomic_ref<unsigned>(*r.cq_tail).load(std::memory_order_acquire);
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe &cqe = r.cqes[head & *r.cq_mask];
+                    std::size_t index = cqe.user_data >> 2;
+                    ring::slot &slot = r.slots[index];
+                    --r.in_flight;
+                    --slot.pending;
+
+                    switch (cqe.user_data & 3)
+                    {
+                    case ring::op_open:
+                        slot.open_result = cqe.res;
+                        if (cqe.res >= 0)
+                            slot.fd = cqe.res;
+                        break;
+                    case ring::op_statx:
+                        slot.statx_result = cqe.res;
+                        break;
+                    case ring::op_advise:
+                        break;
+                    }
+                    if (slot.pending)
+                        continue;
+
+                    if ((cqe.user_data & 3) == ring::op_advise)
+                        ready_.push_back(finish(index));
+                    else if (slot.open_result < 0 || slot.statx_result < 0)
+                    {
+                        // Unsupported opcode or a real error: the constructor
+                        // either succeeds or reports it the usual way
+                        if (slot.fd != -1)
+                            close(std::exchange(slot.fd, -1));
+                        ready_.push_back(open_directly(index));
+                    }
+                    else if (!opts_.readahead || slot.stx.stx_size < readahead_min || !r.submit_advise(index))
+                        ready_.push_back(finish(index)); // small files fault in a page or two anyway
+                }
+                std::atomic_ref<unsigned>(*r.cq_head).store(head, std::memory_order_release);
+            }
+
+            opened_source out = std::move(ready_.front());
+            ready_.pop_front();
+            --r.active;
+            ++delivered_;
+            return out;
+        }
+#endif
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_cv_.wait(lock, [this]
+                       { return !ready_.empty(); });
+        opened_source out = std::move(ready_.front());
+        ready_.pop_front();
+        --pending_;
+        ++delivered_;
+        lock.unlock();
+        space_cv_.notify_one();
+        return out;
+    }
+
+    void batch_opener::work()
+    {
+        for (;;)
+        {
+            // Like the ring, keep at most queue_depth files open ahead of the consumer
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_cv_.wait(lock, [this]
+                               { return stop_ || pending_ < opts_.queue_depth; });
+                if (stop_)
+                    return;
+                ++pending_;
+            }
+
+            std::size_t index = next_path_.fetch_add(1);
+            if (index >= paths_.size())
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+                return;
+            }
+
+            opened_source out{index, nullptr, nullptr};
+            try
+            {
+                out.src = std::make_unique<source>(paths_[index].c_str(), opts_.endings, opts_.enc);
+            }
+            catch (...)
+            {
+                out.error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ready_.push_back(std::move(out));
+            }
+            ready_cv_.notify_one();
+        }
+    }
+
+    bool batch_opener::uses_io_uring() const
+    {
+        return ring_ != nullptr;
+    }
+
+    std::size_t batch_opener::size() const
+    {
+        return paths_.size();
+    }
+
+} // namespace mms
@@ -0,0 +1,147 @@
+/// \file
+/// \brief Implementation of the `mms::binary_reader` class, a reader of binary file formats.
+///
+/// Values are copied out of the mapping with `memcpy`, which compiles to a
+/// single unaligned load, after one bounds check. Tables of foreign-order
+/// integers are converted by the shared byte-swapping primitive.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <limits>
+
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    binary_reader::binary_reader(const file &f, std::endian order)
+        : binary_reader(f.data(), f.size(), order) {}
+
+    binary_reader::binary_reader(const char *data, std::size_t size, std::endian order)
+        : data_(data), size_(size), pos_(0), order_(order) {}
+
+    void binary_reader::seek(std::size_t pos)
+    {
+        if (pos > size_)
+            throw std::out_of_range("binary_reader: seek to offset " + std::to_string(pos) +
+                                    " past the end of " + std::to_string(size_) + " bytes");
+        pos_ = pos;
+    }
+
+    void binary_reader::skip(std::size_t n)
+    {
+        require(n);
+        pos_ += n;
+    }
+
+    binary_reader binary_reader::sub(std::size_t offset, std::size_t size) const
+    {
+        if (offset > size_ || size > size_ - offset)
+            throw std::out_of_range("binary_reader: region of " + std::to_string(size) + " bytes at offset " +
+                                    std::to_string(offset) + " exceeds " + std::to_string(size_) + " bytes");
+        return binary_reader(data_ + offset, size, order_);
+    }
+
+    std::uint64_t binary_reader::read_uleb128()
+    {
+        std::uint64_t value = 0;
+        unsigned shift = 0;
+        for (std::size_t i = pos_; i < size_; ++i)
+        {
+            auto byte = static_cast<unsigned char>(data_[i]);
+            std::uint64_t bits = byte & 0x7F;
+            if (shift >= 64 || (shift == 63 && bits > 1))
+                throw std::invalid_argument("binary_reader: LEB128 number at offset " + std::to_string(pos_) +
+                                            " does not fit in 64 bits");
+            value |= bits << shift;
+            shift += 7;
+            if (!(byte & 0x80))
+            {
+                pos_ = i + 1;
+                return value;
+            }
+        }
+        throw std::out_of_range("binary_reader: LEB128 number at offset " + std::to_string(pos_) +
+                                " runs past the end");
+    }
+
+    std::int64_t binary_reader::read_sleb128()
+    {
+        std::uint64_t value = 0;
+        unsigned shift = 0;
+        for (std::size_t i = pos_; i < size_; ++i)
+        {
+            auto byte = static_cast<unsigned char>(data_[i]);
+            std::uint64_t bits = byte & 0x7F;
+            if (shift >= 64 || (shift == 63 && bits != 0 && bits != 0x7F))
+                throw std::invalid_argument("binary_reader: LEB128 number at offset " + std::to_string(pos_) +
+                                            " does not fit in 64 bits");
+            value |= bits << shift;
+            shift += 7;
+            if (!(byte & 0x80))
+            {
+                // Extend the sign bit of the last group
+                if (shift < 64 && (byte & 0x40))
+                    value |= ~std::uint64_t{0} << shift;
+                pos_ = i + 1;
+                return static_cast<std::int64_t>(value);
+            }
+        }
+        throw std::out_of_range("binary_reader: LEB128 number at offset " + std::to_string(pos_) +
+                                " runs past the end");
+    }
+
+    std::string_view binary_reader::read_string()
+    {
+        const void *end = std::memchr(data_ + pos_, '\0', size_ - pos_);
+        if (!end)
+            throw std::out_of_range("binary_reader: string at offset " + std::to_string(pos_) +
+                                    " is not terminated");
+        std::string_view text(data_ + pos_, static_cast<const char *>(end) - (data_ + pos_));
+        pos_ += text.size() + 1;
+        return text;
+    }
+
+    std::span<const std::byte> binary_reader::read_bytes(std::size_t n)
+    {
+        require(n);
+        std::span<const std::byte> bytes(reinterpret_cast<const std::byte *>(data_ + pos_), n);
+        pos_ += n;
+        return bytes;
+    }
+
+    void binary_reader::require(std::size_t n) const
+    {
+        if (n > size_ - pos_)
+            throw std::out_of_range("binary_reader: read of " + std::to_string(n) + " bytes at offset " +
+                                    std::to_string(pos_) + " past the end of " + std::to_string(size_) + " bytes");
+    }
+
+    void binary_reader::require_array(std::size_t count, std::size_t width) const
+    {
+        if (count > std::numeric_limits<std::size_t>::max() / width)
+            throw std::out_of_range("binary_reader: table of " + std::to_string(count) + " values is too large");
+        require(count * width);
+    }
+
+    void binary_reader::require_aligned(std::size_t alignment) const
+    {
+        if (reinterpret_cast<std::uintptr_t>(data_ + pos_) % alignment != 0)
+            throw std::invalid_argument("binary_reader: offset " + std::to_string(pos_) +
+                                        " is not aligned for the viewed type");
+    }
+
+    void binary_reader::copy_ints(void *out, std::size_t count, std::size_t width)
+    {
+        const char *from = data_ + pos_;
+        if (order_ == std::endian::native || width == 1)
+            std::memcpy(out, from, count * width);
+        else
+            scan::byteswap(from, static_cast<char *>(out), count, width);
+        pos_ += count * width;
+    }
+
+} // namespace mms
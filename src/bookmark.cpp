@@ -13,8 +13,8 @@
 namespace mms
 {
 
-    bookmark::bookmark(std::size_t pos, int line, int column)
-        : pos_(pos), line_(line), column_(column) {}
+    bookmark::bookmark(std::size_t pos, int line, int column, std::uint32_t generation)
+        : pos_(pos), line_(line), column_(column), generation_(generation) {}
 
     std::size_t bookmark::position() const
     {
@@ -31,4 +31,9 @@ namespace mms
         return column_;
     }
 
+    std::uint32_t bookmark::generation() const
+    {
+        return generation_;
+    }
+
 } // namespace mms
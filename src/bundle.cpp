@@ -0,0 +1,237 @@
+/// \file
+/// \brief Implementation of the `mms::bundle_builder` and `mms::bundle` classes.
+///
+/// A bundle is laid out as a 16-byte header, the bytes of every member,
+/// their paths, the line break positions of the UTF-8 members, the member
+/// table and an 8-byte trailer locating the table. The table comes last so
+/// that members can be streamed in one at a time. All integers are
+/// little-endian; the tables are 8-byte aligned.
+///
+///     header   "MMSBUNDL", u32 version, u32 members
+///     member   u64 path offset, u32 path size, u32 line ending,
+///              u64 text offset, u64 text size, u64 index offset, u64 breaks
+///     trailer  u64 table offset
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    namespace
+    {
+        constexpr char magic[8] = {'M', 'M', 'S', 'B', 'U', 'N', 'D', 'L'};
+        constexpr std::uint32_t version = 1;
+        constexpr std::size_t header_size = 16;
+        constexpr std::size_t record_size = 48;
+
+        // Append an integer in little-endian byte order
+        template <std::integral T>
+        void put(sink &out, T value)
+        {
+            char bytes[sizeof(T)];
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+                bytes[i] = static_cast<char>(static_cast<std::make_unsigned_t<T>>(value) >> (8 * i));
+            out.write(bytes, sizeof(T));
+        }
+
+        void align(sink &out)
+        {
+            static constexpr char zeros[8] = {};
+            out.write(zeros, (8 - out.size() % 8) % 8);
+        }
+    } // namespace
+
+    void bundle_builder::add(const std::string &path)
+    {
+        members_.emplace_back(path, path);
+    }
+
+    void bundle_builder::add(std::string name, const std::string &path)
+    {
+        members_.emplace_back(std::move(name), path);
+    }
+
+    std::size_t bundle_builder::size() const
+    {
+        return members_.size();
+    }
+
+    void bundle_builder::write(const char *filename) const
+    {
+        // Sorted by name, so that readers can search the table
+        std::vector<const std::pair<std::string, std::string> *> order;
+        for (const auto &m : members_)
+            order.push_back(&m);
+        std::sort(order.begin(), order.end(), [](auto *a, auto *b) { return a->first < b->first; });
+        for (std::size_t i = 1; i < order.size(); ++i)
+            if (order[i - 1]->first == order[i]->first)
+                throw std::invalid_argument("bundle_builder: duplicate member " + order[i]->first);
+
+        struct record
+        {
+            std::uint64_t path_offset;
+            std::uint64_t text_offset;
+            std::uint64_t text_size;
+            line_ending endings;
+            std::vector<std::size_t> breaks;
+            std::uint64_t index_offset;
+        };
+        std::vector<record> records(order.size());
+
+        sink out(filename);
+        out.write(magic, sizeof magic);
+        put(out, version);
+        put(out, static_cast<std::uint32_t>(order.size()));
+
+        // Member bytes, indexed the way a source would index them while mapped
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            file f(order[i]->second.c_str());
+            record &r = records[i];
+            r.text_offset = out.size();
+            r.text_size = f.size();
+            r.endings = line_ending::detect;
+
+            std::size_t bom = 0;
+            if (detect_encoding(f.data(), f.size(), bom) == encoding::utf8)
+            {
+                line_index idx(f.data() + bom, f.size() - bom, line_ending::detect);
+                r.endings = idx.endings();
+                r.breaks = idx.newline_positions();
+            }
+            out.write(f.data(), f.size());
+        }
+
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            records[i].path_offset = out.size();
+            out.write(order[i]->first.data(), order[i]->first.size());
+        }
+
+        align(out);
+        for (record &r : records)
+        {
+            r.index_offset = r.breaks.empty() ? 0 : out.size();
+            for (std::size_t b : r.breaks)
+                put(out, static_cast<std::uint64_t>(b));
+        }
+
+        const std::uint64_t table = out.size();
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            const record &r = records[i];
+            put(out, r.path_offset);
+            put(out, static_cast<std::uint32_t>(order[i]->first.size()));
+            put(out, static_cast<std::uint32_t>(r.endings));
+            put(out, r.text_offset);
+            put(out, r.text_size);
+            put(out, r.index_offset);
+            put(out, static_cast<std::uint64_t>(r.breaks.size()));
+        }
+        put(out, table);
+        out.close();
+    }
+
+    bundle::bundle(const char *filename)
+        : file_(std::make_shared<const file>(filename))
+    {
+        const std::string name(filename);
+        if (file_->size() < header_size + 8 || std::memcmp(file_->data(), magic, sizeof magic) != 0)
+            throw std::ios_base::failure("bundle: " + name + " is not a bundle");
+
+        binary_reader in(*file_);
+        in.skip(sizeof magic);
+        if (in.read_le<std::uint32_t>() != version)
+            throw std::ios_base::failure("bundle: " + name + " has an unsupported version");
+        std::uint32_t count = in.read_le<std::uint32_t>();
+
+        in.seek(file_->size() - 8);
+        std::uint64_t table = in.read_le<std::uint64_t>();
+        if (table > file_->size() - 8 || file_->size() - 8 - table != std::uint64_t{count} * record_size)
+            throw std::ios_base::failure("bundle: " + name + " has a corrupt member table");
+
+        in.seek(table);
+        members_.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            std::uint64_t path_offset = in.read_le<std::uint64_t>();
+            std::uint32_t path_size = in.read_le<std::uint32_t>();
+            std::uint32_t endings = in.read_le<std::uint32_t>();
+            std::uint64_t text_offset = in.read_le<std::uint64_t>();
+            std::uint64_t text_size = in.read_le<std::uint64_t>();
+            std::uint64_t index_offset = in.read_le<std::uint64_t>();
+            std::uint64_t breaks = in.read_le<std::uint64_t>();
+
+            // Check every region before handing out views of it
+            binary_reader path = in.sub(path_offset, path_size);
+            binary_reader text = in.sub(text_offset, text_size);
+            if (breaks > file_->size() / 8)
+                throw std::out_of_range("bundle: line index of member " + std::to_string(i) + " exceeds the bundle");
+            in.sub(index_offset, breaks * 8);
+            if (endings > static_cast<std::uint32_t>(line_ending::detect))
+                throw std::ios_base::failure("bundle: " + name + " has a corrupt member table");
+
+            members_.push_back(member{std::string_view(path.data(), path.size()),
+                                      std::string_view(text.data(), text.size()),
+                                      static_cast<line_ending>(endings), index_offset, breaks});
+        }
+    }
+
+    std::size_t bundle::size() const
+    {
+        return members_.size();
+    }
+
+    std::string_view bundle::path(std::size_t i) const
+    {
+        return members_.at(i).path;
+    }
+
+    std::optional<std::size_t> bundle::find(std::string_view path) const
+    {
+        auto it = std::lower_bound(members_.begin(), members_.end(), path,
+                                   [](const member &m, std::string_view p) { return m.path < p; });
+        if (it == members_.end() || it->path != path)
+            return std::nullopt;
+        return static_cast<std::size_t>(it - members_.begin());
+    }
+
+    std::string_view bundle::contents(std::size_t i) const
+    {
+        return members_.at(i).text;
+    }
+
+    std::unique_ptr<source> bundle::open(std::size_t i) const
+    {
+        const member &m = members_.at(i);
+        auto src = std::make_unique<source>(file(file_, m.text.data(), m.text.size(), std::string(m.path)),
+                                            m.endings);
+        if (m.breaks > 0)
+        {
+            binary_reader in(file_->data() + m.index_offset, m.breaks * 8);
+            std::vector<std::size_t> breaks(m.breaks);
+            for (std::size_t &b : breaks)
+                b = static_cast<std::size_t>(in.read_le<std::uint64_t>());
+            if (breaks.back() >= src->size())
+                throw std::out_of_range("bundle: line index of " + std::string(m.path) + " exceeds its text");
+            src->index_ = std::make_unique<line_index>(std::move(breaks), src->data(), src->endings());
+        }
+        return src;
+    }
+
+    std::unique_ptr<source> bundle::open(std::string_view path) const
+    {
+        std::optional<std::size_t> i = find(path);
+        if (!i)
+            throw std::ios_base::failure("bundle: no member " + std::string(path));
+        return open(*i);
+    }
+
+} // namespace mms
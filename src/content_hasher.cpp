@@ -0,0 +1,241 @@
+/// \file
+/// \brief Implementation of the `mms::content_hasher` class, a 128-bit content hash.
+///
+/// The structure follows XXH3: eight 64-bit accumulators take one 64-byte
+/// stripe at a time, each lane adding the 32x32-bit product of its data
+/// XOR a key and, crosswise, the raw data of its neighbour lane. The key
+/// window slides by one word per stripe, so stripes do not commute, and
+/// the accumulators are scrambled after every 16 stripes. The SSE2 and
+/// scalar paths compute the same values; the constants are our own, so
+/// digests are not XXH3-compatible.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cstring>
+
+#include <mms/mms.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace mms
+{
+
+    namespace
+    {
+        constexpr unsigned stripe_size = 64;
+        constexpr unsigned stripes_per_block = 16;
+        constexpr std::uint64_t prime32 = 0x9E3779B1u;
+        constexpr std::uint64_t prime64_1 = 0x9E3779B185EBCA87ull;
+        constexpr std::uint64_t prime64_2 = 0xC2B2AE3D27D4EB4Full;
+
+        // Key words: a sliding window of 8 per stripe, then 8 for the scramble
+        constexpr auto secret = []
+        {
+            std::array<std::uint64_t, stripes_per_block + 16> k{};
+            std::uint64_t x = 0x6D6D735F68617368ull; // splitmix64
+            for (auto &w : k)
+            {
+                std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                w = z ^ (z >> 31);
+            }
+            return k;
+        }();
+        constexpr const std::uint64_t *scramble_key = secret.data() + stripes_per_block;
+
+#if defined(__SIZEOF_INT128__)
+        __extension__ typedef unsigned __int128 uint128;
+
+        // XOR of the low and high halves of the 128-bit product
+        inline std::uint64_t fold(std::uint64_t a, std::uint64_t b)
+        {
+            uint128 p = static_cast<uint128>(a) * b;
+            return static_cast<std::uint64_t>(p) ^ static_cast<std::uint64_t>(p >> 64);
+        }
+#else
+        // XOR of the low and high halves of the 128-bit product, from 32-bit parts
+        inline std::uint64_t fold(std::uint64_t a, std::uint64_t b)
+        {
+            std::uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+            std::uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+            std::uint64_t lo_lo = a_lo * b_lo;
+            std::uint64_t hi_lo = a_hi * b_lo;
+            std::uint64_t lo_hi = a_lo * b_hi;
+            std::uint64_t hi_hi = a_hi * b_hi;
+            std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+            std::uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+            std::uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFFu);
+            return low ^ high;
+        }
+#endif
+
+        inline std::uint64_t avalanche(std::uint64_t h)
+        {
+            h ^= h >> 37;
+            h *= 0x165667919E3779F9ull;
+            return h ^ (h >> 32);
+        }
+
+        // Accumulate `count` stripes at p; `stripe` is the position within the current block
+        void accumulate(std::uint64_t *acc, const char *p, std::size_t count, unsigned &stripe)
+        {
+#if defined(__SSE2__)
+            __m128i a[4];
+            for (int j = 0; j < 4; ++j)
+                a[j] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc) + j);
+            const __m128i prime = _mm_set1_epi32(static_cast<int>(prime32));
+
+            for (; count; --count, p += stripe_size)
+            {
+                const std::uint64_t *key = secret.data() + stripe;
+                for (int j = 0; j < 4; ++j)
+                {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p) + j);
+                    __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + 2 * j));
+                    __m128i dk = _mm_xor_si128(d, k);
+                    __m128i product = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+                    __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+                    a[j] = _mm_add_epi64(a[j], _mm_add_epi64(product, swapped));
+                }
+
+                if (++stripe == stripes_per_block)
+                {
+                    stripe = 0;
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(scramble_key + 2 * j));
+                        __m128i x = _mm_xor_si128(_mm_xor_si128(a[j], _mm_srli_epi64(a[j], 47)), k);
+                        __m128i lo = _mm_mul_epu32(x, prime);
+                        __m128i hi = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+                        a[j] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+                    }
+                }
+            }
+
+            for (int j = 0; j < 4; ++j)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(acc) + j, a[j]);
+#else
+            for (; count; --count, p += stripe_size)
+            {
+                const std::uint64_t *key = secret.data() + stripe;
+                for (int i = 0; i < 8; ++i)
+                {
+                    std::uint64_t d;
+                    std::memcpy(&d, p + 8 * i, 8);
+                    std::uint64_t dk = d ^ key[i];
+                    acc[i ^ 1] += d;
+                    acc[i] += (dk & 0xFFFFFFFFu) * (dk >> 32);
+                }
+
+                if (++stripe == stripes_per_block)
+                {
+                    stripe = 0;
+                    for (int i = 0; i < 8; ++i)
+                        acc[i] = (acc[i] ^ (acc[i] >> 47) ^ scramble_key[i]) * prime32;
+                }
+            }
+#endif
+        }
+    } // namespace
+
+    std::string digest::hex() const
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(32, '0');
+        for (int i = 0; i < 16; ++i)
+        {
+            out[15 - i] = digits[(high >> (4 * i)) & 0xF];
+            out[31 - i] = digits[(low >> (4 * i)) & 0xF];
+        }
+        return out;
+    }
+
+    content_hasher::content_hasher()
+        : acc_{prime32, prime64_1, prime64_2, 0x165667B19E3779F9ull,
+               0x85EBCA77C2B2AE63ull, 0x27D4EB2F165667C5ull, prime64_2 ^ prime32, prime64_1 + prime32},
+          stripe_(0), buffered_(0), length_(0)
+    {
+    }
+
+    void content_hasher::update(const char *data, std::size_t size)
+    {
+        length_ += size;
+
+        if (buffered_)
+        {
+            std::size_t n = std::min<std::size_t>(size, stripe_size - buffered_);
+            std::memcpy(buffer_ + buffered_, data, n);
+            buffered_ += n;
+            data += n;
+            size -= n;
+            if (buffered_ < stripe_size)
+                return;
+            accumulate(acc_, buffer_, 1, stripe_);
+            buffered_ = 0;
+        }
+
+        std::size_t stripes = size / stripe_size;
+        accumulate(acc_, data, stripes, stripe_);
+        data += stripes * stripe_size;
+        size -= stripes * stripe_size;
+
+        if (size)
+            std::memcpy(buffer_, data, size);
+        buffered_ = size;
+    }
+
+    digest content_hasher::finish() const
+    {
+        std::uint64_t acc[8];
+        std::memcpy(acc, acc_, sizeof(acc));
+        if (buffered_)
+        {
+            // The zero padding is told apart from real zeros by the length
+            char last[stripe_size] = {};
+            std::memcpy(last, buffer_, buffered_);
+            unsigned stripe = stripe_;
+            accumulate(acc, last, 1, stripe);
+        }
+
+        digest d;
+        d.low = length_ * prime64_1;
+        d.high = ~length_ * prime64_2;
+        for (int i = 0; i < 4; ++i)
+        {
+            d.low += fold(acc[2 * i] ^ secret[i], acc[2 * i + 1] ^ secret[i + 4]);
+            d.high += fold(acc[2 * i] ^ scramble_key[i + 4], acc[2 * i + 1] ^ scramble_key[i]);
+        }
+        d.low = avalanche(d.low);
+        d.high = avalanche(d.high);
+        return d;
+    }
+
+    digest content_hasher::hash(const char *data, std::size_t size)
+    {
+        content_hasher h;
+        h.update(data, size);
+        return h.finish();
+    }
+
+    std::vector<std::uint64_t> block_digests(const char *data, std::size_t size, std::size_t block, bool from_end)
+    {
+        if (block == 0)
+            throw std::invalid_argument("block_digests: block size must not be zero");
+
+        std::vector<std::uint64_t> out;
+        out.reserve(size / block + 1);
+        for (std::size_t done = 0; done < size; done += block)
+        {
+            std::size_t len = std::min(block, size - done);
+            const char *p = from_end ? data + size - done - len : data + done;
+            out.push_back(content_hasher::hash(p, len).low);
+        }
+        return out;
+    }
+
+} // namespace mms
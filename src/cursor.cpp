@@ -0,0 +1,129 @@
+/// \file
+/// \brief Implementation of the `mms::cursor` class.
+///
+/// A cursor is the per-thread reading state over a shared `mapped_source`:
+/// a byte position with its line and column. It never modifies the source,
+/// so cursors on different threads need no synchronization.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    cursor::cursor(const mapped_source &src)
+        : source_(&src), pos_(0), line_(1), column_(1),
+          break_char_(src.endings() == line_ending::cr ? '\r' : '\n') {}
+
+    int cursor::get()
+    {
+        if (pos_ >= source_->size())
+            return EOF;
+
+        char ch = source_->data()[pos_];
+        if (ch == break_char_)
+        {
+            ++line_;
+            column_ = 1;
+        }
+        else if (ch != '\r' || !is_zero_width_cr(pos_))
+        {
+            ++column_;
+        }
+        ++pos_;
+        return static_cast<unsigned char>(ch);
+    }
+
+    int cursor::peek() const
+    {
+        if (pos_ >= source_->size())
+            return EOF;
+
+        return static_cast<unsigned char>(source_->data()[pos_]);
+    }
+
+    void cursor::putback()
+    {
+        if (pos_ == 0)
+            return;
+
+        --pos_;
+        char ch = source_->data()[pos_];
+        if (ch == break_char_)
+        {
+            --line_;
+            column_ = source_->index().column_of(pos_);
+        }
+        else if (ch != '\r' || !is_zero_width_cr(pos_))
+        {
+            --column_;
+        }
+    }
+
+    bool cursor::is_zero_width_cr(std::size_t pos) const
+    {
+        return source_->endings() == line_ending::crlf &&
+               pos + 1 < source_->size() && source_->data()[pos + 1] == '\n';
+    }
+
+    cursor::operator bool() const
+    {
+        return pos_ < source_->size();
+    }
+
+    std::size_t cursor::position() const
+    {
+        return pos_;
+    }
+
+    int cursor::line() const
+    {
+        return line_;
+    }
+
+    int cursor::column() const
+    {
+        return column_;
+    }
+
+    bookmark cursor::mark() const
+    {
+        return bookmark(pos_, line_, column_);
+    }
+
+    void cursor::seek(const bookmark &b)
+    {
+        pos_ = b.position();
+        line_ = b.line();
+        column_ = b.column();
+    }
+
+    void cursor::seek(std::size_t pos)
+    {
+        if (pos > source_->size())
+            pos = source_->size();
+
+        const line_index &idx = source_->index();
+        pos_ = pos;
+        line_ = idx.line_of(pos);
+        column_ = idx.column_of(pos);
+    }
+
+    const char *cursor::data() const
+    {
+        return source_->data();
+    }
+
+    std::size_t cursor::size() const
+    {
+        return source_->size();
+    }
+
+    line_ending cursor::endings() const
+    {
+        return source_->endings();
+    }
+
+} // namespace mms
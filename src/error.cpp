@@ -0,0 +1,54 @@
+/// \file
+/// \brief Implementation of the `mms::errc` error category.
+///
+/// Errors of the non-throwing API that do not come from a system call
+/// are reported as `std::error_code` values in this category.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <string>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    namespace
+    {
+        class mms_category : public std::error_category
+        {
+        public:
+            const char *name() const noexcept override
+            {
+                return "mms";
+            }
+
+            std::string message(int value) const override
+            {
+                switch (static_cast<errc>(value))
+                {
+                case errc::invalid_integer:
+                    return "Invalid integer input";
+                case errc::unexpected_eof:
+                    return "Unexpected EOF";
+                case errc::invalid_number:
+                    return "Invalid number";
+                }
+                return "Unknown error";
+            }
+        };
+    } // namespace
+
+    const std::error_category &error_category() noexcept
+    {
+        static const mms_category category;
+        return category;
+    }
+
+    std::error_code make_error_code(errc e) noexcept
+    {
+        return std::error_code(static_cast<int>(e), error_category());
+    }
+
+} // namespace mms
@@ -12,7 +12,9 @@
 #include <unistd.h>   // close, lseek
 #include <sys/mman.h> // mmap, munmap, madvise
 #include <cstring>    // strerror
+#include <new>        // std::bad_alloc
 #include <stdexcept>  // std::ios_base::failure
+#include <utility>    // std::exchange
 
 #include <mms/mms.h>
 
@@ -20,10 +22,10 @@ namespace mms
 {
 
     file::file(const char *filename)
-        : file_descriptor_(-1), file_size_(0), mapped_data_(nullptr)
+        : file_descriptor_(-1), file_size_(0), mapped_data_(nullptr), path_(filename)
     {
         // Open the file
-        file_descriptor_ = open(filename, O_RDONLY);
+        file_descriptor_ = ::open(filename, O_RDONLY);
         if (file_descriptor_ == -1)
         {
             throw std::ios_base::failure("Error opening file: " + std::string(strerror(errno)));
@@ -37,6 +39,73 @@ namespace mms
             throw std::ios_base::failure("Error determining file size: " + std::string(strerror(errno)));
         }
 
+        map();
+    }
+
+    file::file(int fd, std::size_t size, std::string path)
+        : file_descriptor_(fd), file_size_(size), mapped_data_(nullptr), path_(std::move(path))
+    {
+        if (file_descriptor_ == -1)
+        {
+            throw std::ios_base::failure("Error opening file: invalid descriptor");
+        }
+        map();
+    }
+
+    file::file(int fd, std::size_t size, const char *mapped, std::string path) noexcept
+        : file_descriptor_(fd), file_size_(size), mapped_data_(mapped), path_(std::move(path)) {}
+
+    file::file(std::shared_ptr<const file> owner, const char *data, std::size_t size, std::string path) noexcept
+        : file_descriptor_(-1), file_size_(size), mapped_data_(data), path_(std::move(path)),
+          owner_(std::move(owner)) {}
+
+    result<file> file::open(const char *filename) noexcept
+    {
+        int fd = ::open(filename, O_RDONLY);
+        if (fd == -1)
+            return std::error_code(errno, std::system_category());
+
+        off_t size = lseek(fd, 0, SEEK_END);
+        const char *mapped = nullptr;
+        if (size > 0)
+        {
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+                size = -1;
+            else
+                mapped = static_cast<const char *>(p);
+        }
+        if (size == -1)
+        {
+            std::error_code error(errno, std::system_category());
+            close(fd);
+            return error;
+        }
+
+#ifdef POSIX_MADV_SEQUENTIAL
+        if (mapped)
+            posix_madvise(const_cast<char *>(mapped), size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+        // Copying the path and registering the mapping may allocate
+        try
+        {
+            std::string path(filename);
+            if (mapped)
+                MMS_STAT(detail::track_mapping(mapped, static_cast<std::size_t>(size), true));
+            return file(fd, static_cast<std::size_t>(size), mapped, std::move(path));
+        }
+        catch (const std::bad_alloc &)
+        {
+            if (mapped)
+                munmap(const_cast<char *>(mapped), size);
+            close(fd);
+            return std::make_error_code(std::errc::not_enough_memory);
+        }
+    }
+
+    void file::map()
+    {
         // Memory-map the file if not empty
         if (file_size_ > 0)
         {
@@ -52,6 +121,7 @@ namespace mms
 #ifdef POSIX_MADV_SEQUENTIAL
             posix_madvise(const_cast<char *>(mapped_data_), file_size_, POSIX_MADV_SEQUENTIAL);
 #endif
+            MMS_STAT(detail::track_mapping(mapped_data_, file_size_, true));
         }
         else
         {
@@ -59,10 +129,34 @@ namespace mms
         }
     }
 
+    file::file(file &&other) noexcept
+        : file_descriptor_(std::exchange(other.file_descriptor_, -1)),
+          file_size_(std::exchange(other.file_size_, 0)),
+          mapped_data_(std::exchange(other.mapped_data_, nullptr)),
+          path_(std::move(other.path_)),
+          digest_(std::exchange(other.digest_, std::nullopt)),
+          owner_(std::move(other.owner_)) {}
+
+    file &file::operator=(file &&other) noexcept
+    {
+        if (this != &other)
+        {
+            file old(std::move(*this));
+            file_descriptor_ = std::exchange(other.file_descriptor_, -1);
+            file_size_ = std::exchange(other.file_size_, 0);
+            mapped_data_ = std::exchange(other.mapped_data_, nullptr);
+            path_ = std::move(other.path_);
+            digest_ = std::exchange(other.digest_, std::nullopt);
+            owner_ = std::move(other.owner_);
+        }
+        return *this;
+    }
+
     file::~file()
     {
-        if (mapped_data_ && mapped_data_ != MAP_FAILED)
+        if (mapped_data_ && mapped_data_ != MAP_FAILED && !owner_)
         {
+            MMS_STAT(detail::track_mapping(mapped_data_, file_size_, false));
             munmap(const_cast<char *>(mapped_data_), file_size_);
         }
         if (file_descriptor_ != -1)
@@ -83,7 +177,19 @@ namespace mms
 
     bool file::is_open() const
     {
-        return file_descriptor_ != -1;
+        return file_descriptor_ != -1 || owner_;
+    }
+
+    const std::string &file::path() const
+    {
+        return path_;
+    }
+
+    digest file::content_digest() const
+    {
+        if (!digest_)
+            digest_ = content_hasher::hash(mapped_data_, file_size_);
+        return *digest_;
     }
 
 } // namespace mms
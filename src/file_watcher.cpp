@@ -0,0 +1,148 @@
+/// \file
+/// \brief Implementation of the `mms::file_watcher` class.
+///
+/// Uses inotify on the directories containing the watched files. Editors
+/// commonly save by writing a temporary file and renaming it over the
+/// original, which replaces the inode; watching the directory entry by
+/// name catches that as well as in-place writes.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <poll.h>        // poll
+#include <sys/inotify.h> // inotify_*
+#include <unistd.h>      // read, close
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    file_watcher::file_watcher()
+        : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    {
+        if (fd_ == -1)
+            throw std::ios_base::failure("Error creating inotify instance: " + std::string(strerror(errno)));
+    }
+
+    file_watcher::~file_watcher()
+    {
+        close(fd_);
+    }
+
+    void file_watcher::add(source &s)
+    {
+        if (s.path().empty())
+            throw std::logic_error("file_watcher: source has no path");
+
+        std::filesystem::path p(s.path());
+        std::string dir = p.has_parent_path() ? p.parent_path().string() : std::string(".");
+
+        auto found = directories_.find(dir);
+        int wd;
+        if (found != directories_.end())
+            wd = found->second;
+        else
+        {
+            wd = inotify_add_watch(fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd == -1)
+                throw std::ios_base::failure("Error watching " + dir + ": " + std::string(strerror(errno)));
+            directories_.emplace(dir, wd);
+        }
+
+        s.enable_change_tracking();
+        sources_[{wd, p.filename().string()}].push_back(&s);
+    }
+
+    void file_watcher::remove(source &s)
+    {
+        for (auto it = sources_.begin(); it != sources_.end();)
+        {
+            auto &list = it->second;
+            list.erase(std::remove(list.begin(), list.end(), &s), list.end());
+            it = list.empty() ? sources_.erase(it) : std::next(it);
+        }
+
+        // Drop the watch of every directory no source is left in
+        for (auto d = directories_.begin(); d != directories_.end();)
+        {
+            auto first = sources_.lower_bound({d->second, std::string()});
+            if (first != sources_.end() && first->first.first == d->second)
+                ++d;
+            else
+            {
+                inotify_rm_watch(fd_, d->second);
+                d = directories_.erase(d);
+            }
+        }
+    }
+
+    void file_watcher::forget_directory(int wd)
+    {
+        // The kernel has dropped the watch, e.g. because the directory was deleted
+        for (auto d = directories_.begin(); d != directories_.end(); ++d)
+            if (d->second == wd)
+            {
+                directories_.erase(d);
+                break;
+            }
+        sources_.erase(sources_.lower_bound({wd, std::string()}), sources_.lower_bound({wd + 1, std::string()}));
+    }
+
+    int file_watcher::descriptor() const
+    {
+        return fd_;
+    }
+
+    std::vector<source *> file_watcher::poll(int timeout_ms)
+    {
+        pollfd pfd{fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, timeout_ms) <= 0)
+            return {};
+
+        // A save usually produces several events; reload each source once
+        std::set<source *> touched;
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            ssize_t got = read(fd_, buffer, sizeof(buffer));
+            if (got <= 0)
+                break;
+            for (ssize_t off = 0; off < got;)
+            {
+                auto *ev = reinterpret_cast<const inotify_event *>(buffer + off);
+                off += sizeof(inotify_event) + ev->len;
+                if (ev->mask & IN_Q_OVERFLOW)
+                {
+                    // Events were lost; any source may have changed
+                    for (const auto &[key, list] : sources_)
+                        touched.insert(list.begin(), list.end());
+                    continue;
+                }
+                if (ev->mask & IN_IGNORED)
+                {
+                    forget_directory(ev->wd);
+                    continue;
+                }
+                if (!ev->len)
+                    continue;
+                auto found = sources_.find({ev->wd, std::string(ev->name)});
+                if (found != sources_.end())
+                    touched.insert(found->second.begin(), found->second.end());
+            }
+        }
+
+        std::vector<source *> changed;
+        for (source *s : touched)
+            if (s->reload())
+                changed.push_back(s);
+        return changed;
+    }
+
+} // namespace mms
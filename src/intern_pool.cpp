@@ -0,0 +1,151 @@
+/// \file
+/// \brief Implementation of the `mms::intern_pool` class, a string interning arena.
+///
+/// Strings are appended to 64 KB blocks (longer ones get a block of their
+/// own) and indexed by a power-of-two, linearly probed table of hashes and
+/// ids kept at most half full. Each slot keeps the full hash, so a probe
+/// compares strings only when the hashes agree.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <cstring>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    namespace
+    {
+        constexpr std::size_t block_size = 64 * 1024;
+        constexpr std::size_t initial_slots = 1024;
+    } // namespace
+
+    intern_pool::intern_pool()
+        : free_(nullptr), left_(0), used_(0)
+    {
+        clear();
+    }
+
+    intern_pool::intern_pool(intern_pool &&other)
+        : blocks_(std::move(other.blocks_)), free_(other.free_), left_(other.left_), used_(other.used_),
+          slots_(std::move(other.slots_)), strings_(std::move(other.strings_))
+    {
+        // A moved-from pool without slots would probe an empty table
+        other.clear();
+    }
+
+    intern_pool &intern_pool::operator=(intern_pool &&other)
+    {
+        if (this != &other)
+        {
+            blocks_ = std::move(other.blocks_);
+            free_ = other.free_;
+            left_ = other.left_;
+            used_ = other.used_;
+            slots_ = std::move(other.slots_);
+            strings_ = std::move(other.strings_);
+            other.clear();
+        }
+        return *this;
+    }
+
+    std::uint64_t intern_pool::hash(std::string_view text) noexcept
+    {
+        std::uint64_t h = hash_seed;
+        for (char c : text)
+            h = hash_step(h, c);
+        return h;
+    }
+
+    symbol intern_pool::intern(std::string_view text)
+    {
+        return intern(text, hash(text));
+    }
+
+    symbol intern_pool::intern(std::string_view text, std::uint64_t hash)
+    {
+        if (text.empty())
+            return symbol{};
+
+        std::size_t i = probe(text, hash);
+        if (slots_[i].id)
+            return symbol{slots_[i].id};
+
+        std::uint32_t id = static_cast<std::uint32_t>(strings_.size());
+        strings_.emplace_back(store(text), text.size());
+        slots_[i] = slot{hash, id};
+        if (strings_.size() * 2 > slots_.size())
+            grow();
+        return symbol{id};
+    }
+
+    std::optional<symbol> intern_pool::find(std::string_view text) const
+    {
+        if (text.empty())
+            return symbol{};
+        std::size_t i = probe(text, hash(text));
+        if (!slots_[i].id)
+            return std::nullopt;
+        return symbol{slots_[i].id};
+    }
+
+    std::size_t intern_pool::probe(std::string_view text, std::uint64_t hash) const
+    {
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            const slot &s = slots_[i];
+            if (!s.id || (s.hash == hash && strings_[s.id] == text))
+                return i;
+        }
+    }
+
+    const char *intern_pool::store(std::string_view text)
+    {
+        std::size_t need = text.size() + 1;
+        if (need > left_)
+        {
+            std::size_t size = std::max(block_size, need);
+            blocks_.push_back(std::make_unique<char[]>(size));
+            free_ = blocks_.back().get();
+            left_ = size;
+        }
+
+        char *p = free_;
+        std::memcpy(p, text.data(), text.size());
+        p[text.size()] = '\0';
+        free_ += need;
+        left_ -= need;
+        used_ += need;
+        return p;
+    }
+
+    void intern_pool::grow()
+    {
+        std::vector<slot> old(slots_.size() * 2, slot{0, 0});
+        old.swap(slots_);
+        const std::size_t mask = slots_.size() - 1;
+        for (const slot &s : old)
+        {
+            if (!s.id)
+                continue;
+            std::size_t i = s.hash & mask;
+            while (slots_[i].id)
+                i = (i + 1) & mask;
+            slots_[i] = s;
+        }
+    }
+
+    void intern_pool::clear()
+    {
+        blocks_.clear();
+        free_ = nullptr;
+        left_ = 0;
+        used_ = 0;
+        slots_.assign(initial_slots, slot{0, 0});
+        strings_.assign(1, std::string_view("", 0));
+    }
+
+} // namespace mms
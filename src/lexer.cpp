@@ -0,0 +1,81 @@
+/// \file
+/// \brief Implementation of the table-driven `mms::dfa_lexer`.
+///
+/// The transition table is produced at compile time by `make_dfa`; this
+/// file contains only the runtime engine, which performs maximal-munch
+/// matching directly over the mapped text and tracks positions per token.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    dfa_lexer::dfa_lexer(const dfa_view &table, std::string_view text, location start, line_ending endings)
+        : table_(table), pos_(text.data()), end_(text.data() + text.size()), loc_(start),
+          endings_(endings == line_ending::detect ? detect_line_ending(text.data(), text.size()) : endings) {}
+
+    dfa_lexer::dfa_lexer(const dfa_view &table, const source &s)
+        : table_(table),
+          pos_(s.data() + s.position()),
+          end_(s.data() + s.size()),
+          loc_{s.position(), static_cast<std::uint32_t>(s.line()), static_cast<std::uint32_t>(s.column())},
+          endings_(s.endings()) {}
+
+    lexeme dfa_lexer::next()
+    {
+        const std::uint8_t *classes = table_.classes;
+        const std::uint16_t *next = table_.next;
+        const std::uint16_t *accept = table_.accept;
+        const std::size_t width = table_.class_count;
+
+        while (pos_ < end_)
+        {
+            const char *start = pos_;
+            const char *p = pos_;
+            const char *match_end = nullptr;
+            std::uint16_t id = lex::error;
+            std::uint16_t state = 1;
+
+            // Maximal munch: run until the dead state, remember the last accept
+            while (p < end_)
+            {
+                state = next[state * width + classes[static_cast<unsigned char>(*p)]];
+                if (!state)
+                    break;
+                ++p;
+                if (accept[state])
+                {
+                    id = accept[state];
+                    match_end = p;
+                }
+            }
+
+            pos_ = match_end ? match_end : start + 1;
+            std::string_view text(start, pos_ - start);
+            location at = loc_;
+            loc_ = advance_location(loc_, text, endings_);
+
+            if (id == lex::skip)
+                continue;
+
+            if (id == keyword_source_ && keywords_.slots)
+            {
+                std::uint16_t kw = keywords_.find(text);
+                if (kw)
+                    id = kw;
+            }
+            return lexeme{id, text, at};
+        }
+
+        return lexeme{lex::end, std::string_view(end_, 0), loc_};
+    }
+
+    location dfa_lexer::where() const
+    {
+        return loc_;
+    }
+
+} // namespace mms
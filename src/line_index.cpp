@@ -0,0 +1,151 @@
+/// \file
+/// \brief Implementation of the `mms::line_index` class.
+///
+/// The line index records the byte position of every line break in a buffer,
+/// allowing any byte position to be translated into a line and column with
+/// a binary search instead of a rescan from the start of the file.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    line_ending detect_line_ending(const char *data, std::size_t size)
+    {
+        constexpr std::size_t block = 64 * 1024;
+        scan::ending_counts e = scan::count_endings(data, size < block ? size : block);
+
+        if (e.crlf > 0 && e.crlf >= e.lf && e.crlf >= e.cr)
+            return line_ending::crlf;
+        if (e.cr > e.lf)
+            return line_ending::cr;
+        return line_ending::lf;
+    }
+
+    line_index::line_index(const char *data, std::size_t size, line_ending endings, content_hasher *hasher)
+        : endings_(endings == line_ending::detect ? detect_line_ending(data, size) : endings)
+    {
+        char brk = endings_ == line_ending::cr ? '\r' : '\n';
+        if (!hasher)
+        {
+            scan::find_all(data, size, brk, 0, newlines_);
+        }
+        else
+        {
+            // Hash each chunk while it is still in cache from the newline scan
+            constexpr std::size_t chunk = 32 * 1024;
+            for (std::size_t done = 0; done < size; done += chunk)
+            {
+                std::size_t n = std::min(chunk, size - done);
+                scan::find_all(data + done, n, brk, done, newlines_);
+                hasher->update(data + done, n);
+            }
+        }
+
+        if (endings_ == line_ending::crlf)
+        {
+            crlf_.resize(newlines_.size());
+            flag_crlf(data, 0, newlines_.size());
+        }
+    }
+
+    line_index::line_index(std::vector<std::size_t> newlines, const char *data, line_ending endings)
+        : newlines_(std::move(newlines)), endings_(endings)
+    {
+        if (endings_ == line_ending::crlf)
+        {
+            crlf_.resize(newlines_.size());
+            flag_crlf(data, 0, newlines_.size());
+        }
+    }
+
+    void line_index::flag_crlf(const char *data, std::size_t first, std::size_t last)
+    {
+        std::size_t line_start = first ? newlines_[first - 1] + 1 : 0;
+        for (std::size_t i = first; i < last; ++i)
+        {
+            std::size_t p = newlines_[i];
+            crlf_[i] = p > line_start && data[p - 1] == '\r';
+            line_start = p + 1;
+        }
+    }
+
+    line_ending line_index::endings() const
+    {
+        return endings_;
+    }
+
+    std::size_t line_index::lines() const
+    {
+        return newlines_.size() + 1;
+    }
+
+    int line_index::line_of(std::size_t pos) const
+    {
+        // Number of newlines strictly before pos
+        auto it = std::lower_bound(newlines_.begin(), newlines_.end(), pos);
+        return static_cast<int>(it - newlines_.begin()) + 1;
+    }
+
+    int line_index::column_of(std::size_t pos) const
+    {
+        auto it = std::lower_bound(newlines_.begin(), newlines_.end(), pos);
+
+        // The '\r' of a CRLF pair takes no column
+        int adjust = 0;
+        if (!crlf_.empty() && it != newlines_.end() && *it == pos && crlf_[it - newlines_.begin()])
+            adjust = 1;
+
+        if (it == newlines_.begin())
+            return static_cast<int>(pos) + 1 - adjust;
+        --it;
+        return static_cast<int>(pos - *it) - adjust;
+    }
+
+    std::size_t line_index::line_start(std::size_t line) const
+    {
+        if (line <= 1)
+            return 0;
+        if (line - 2 >= newlines_.size())
+            throw std::out_of_range("Line number out of range");
+        return newlines_[line - 2] + 1;
+    }
+
+    const std::vector<std::size_t> &line_index::newline_positions() const
+    {
+        return newlines_;
+    }
+
+    void line_index::update(const char *data, std::size_t begin, std::size_t old_end, std::size_t new_end)
+    {
+        char brk = endings_ == line_ending::cr ? '\r' : '\n';
+        auto lo = std::lower_bound(newlines_.begin(), newlines_.end(), begin);
+        auto hi = std::lower_bound(lo, newlines_.end(), old_end);
+        std::size_t first = lo - newlines_.begin();
+        std::size_t removed = hi - lo;
+
+        // Breaks after the replaced bytes move with the change in length
+        for (auto it = hi; it != newlines_.end(); ++it)
+            *it = *it - old_end + new_end;
+
+        std::vector<std::size_t> added;
+        scan::find_all(data + begin, new_end - begin, brk, begin, added);
+        newlines_.erase(lo, hi);
+        newlines_.insert(newlines_.begin() + first, added.begin(), added.end());
+
+        if (endings_ == line_ending::crlf)
+        {
+            crlf_.erase(crlf_.begin() + first, crlf_.begin() + first + removed);
+            crlf_.insert(crlf_.begin() + first, added.size(), false);
+            // The first break after the replacement may pair with a new '\r'
+            flag_crlf(data, first, std::min(first + added.size() + 1, newlines_.size()));
+        }
+    }
+
+} // namespace mms
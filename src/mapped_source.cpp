@@ -0,0 +1,96 @@
+/// \file
+/// \brief Implementation of the `mms::mapped_source` class.
+///
+/// A `mapped_source` owns a read-only mapping that many threads may read at
+/// once through their own `cursor` objects. The line index is created lazily
+/// by the first thread to claim it with a compare-and-swap and published
+/// with a release store;
+/// threads asking meanwhile wait on the claim instead of building copies.
+/// Once published, readers never take a lock.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    mapped_source::mapped_source(const char *filename, line_ending endings)
+        : file_(filename),
+          endings_(endings == line_ending::detect ? detect_line_ending(file_.data(), file_.size())
+                                                  : endings),
+          index_(nullptr), building_(false) {}
+
+    mapped_source::~mapped_source()
+    {
+        delete index_.load(std::memory_order_acquire);
+    }
+
+    const char *mapped_source::data() const
+    {
+        return file_.data();
+    }
+
+    std::size_t mapped_source::size() const
+    {
+        return file_.size();
+    }
+
+    const line_index &mapped_source::index() const
+    {
+        const line_index *idx = index_.load(std::memory_order_acquire);
+        if (idx)
+            return *idx;
+
+        // Claim the build, or wait for the thread that claimed it
+        for (;;)
+        {
+            bool expected = false;
+            if (building_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                break;
+            building_.wait(true, std::memory_order_acquire);
+            if ((idx = index_.load(std::memory_order_acquire)))
+                return *idx;
+        }
+
+        // The previous builder may have published before we claimed
+        if ((idx = index_.load(std::memory_order_acquire)))
+        {
+            building_.store(false, std::memory_order_release);
+            building_.notify_all();
+            return *idx;
+        }
+
+        MMS_STAT(detail::index_build_timer timer);
+        const line_index *built = nullptr;
+        try
+        {
+            built = new line_index(file_.data(), file_.size(), endings_);
+        }
+        catch (...)
+        {
+            // Let a waiting thread try instead
+            building_.store(false, std::memory_order_release);
+            building_.notify_all();
+            throw;
+        }
+        MMS_STAT(timer.done(built->lines()));
+        // Only the claiming thread publishes
+        index_.store(built, std::memory_order_release);
+        building_.store(false, std::memory_order_release);
+        building_.notify_all();
+        return *built;
+    }
+
+    bool mapped_source::has_index() const
+    {
+        return index_.load(std::memory_order_acquire) != nullptr;
+    }
+
+    line_ending mapped_source::endings() const
+    {
+        return endings_;
+    }
+
+} // namespace mms
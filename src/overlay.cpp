@@ -0,0 +1,368 @@
+/// \file
+/// \brief Implementation of the `mms::overlay` class, a piece table over a source.
+///
+/// The document is an ordered list of pieces referring either to the
+/// original (mapped) text or to an append-only buffer holding inserted
+/// text. Line breaks of the original come from the base source's line
+/// index; breaks of inserted text are recorded as it is appended. The
+/// breaks inside a piece are therefore a sub-range of a sorted vector,
+/// found with two binary searches, and an edit only scans the new text.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    overlay::overlay(const source &base)
+        : original_(base.data()),
+          original_breaks_(&base.index().newline_positions()),
+          endings_(base.endings()),
+          break_char_(endings_ == line_ending::cr ? '\r' : '\n'),
+          piece_(0), cur_(nullptr), end_(nullptr), pos_(0), line_(1), column_(1)
+    {
+        if (base.size() > 0)
+            pieces_.push_back(piece{false, 0, base.size()});
+        refresh();
+        enter(0, 0);
+    }
+
+    const char *overlay::buffer(const piece &p) const
+    {
+        return p.added ? added_.data() : original_;
+    }
+
+    const std::vector<std::size_t> &overlay::breaks(const piece &p) const
+    {
+        return p.added ? added_breaks_ : *original_breaks_;
+    }
+
+    void overlay::refresh()
+    {
+        offsets_.resize(pieces_.size() + 1);
+        breaks_before_.resize(pieces_.size() + 1);
+
+        std::size_t offset = 0, lines = 0;
+        for (std::size_t k = 0; k < pieces_.size(); ++k)
+        {
+            const piece &p = pieces_[k];
+            const auto &b = breaks(p);
+            offsets_[k] = offset;
+            breaks_before_[k] = lines;
+            offset += p.length;
+            lines += std::lower_bound(b.begin(), b.end(), p.start + p.length) -
+                     std::lower_bound(b.begin(), b.end(), p.start);
+        }
+        offsets_.back() = offset;
+        breaks_before_.back() = lines;
+    }
+
+    std::size_t overlay::piece_at(std::size_t pos) const
+    {
+        if (pieces_.empty())
+            return 0;
+        auto it = std::upper_bound(offsets_.begin(), offsets_.end() - 1, pos);
+        return static_cast<std::size_t>(it - offsets_.begin()) - 1;
+    }
+
+    char overlay::at(std::size_t pos) const
+    {
+        std::size_t k = piece_at(pos);
+        const piece &p = pieces_[k];
+        return buffer(p)[p.start + pos - offsets_[k]];
+    }
+
+    std::size_t overlay::split(std::size_t pos)
+    {
+        if (pos == size())
+            return pieces_.size();
+
+        std::size_t k = piece_at(pos);
+        std::size_t within = pos - offsets_[k];
+        if (within == 0)
+            return k;
+
+        piece right = pieces_[k];
+        right.start += within;
+        right.length -= within;
+        pieces_[k].length = within;
+        pieces_.insert(pieces_.begin() + k + 1, right);
+        refresh();
+        return k + 1;
+    }
+
+    void overlay::replace(std::size_t pos, std::size_t length, std::string_view text)
+    {
+        if (pos > size())
+            throw std::out_of_range("overlay: position out of range");
+        length = std::min(length, size() - pos);
+
+        std::size_t first = split(pos);
+        std::size_t last = split(pos + length);
+        pieces_.erase(pieces_.begin() + first, pieces_.begin() + last);
+
+        if (!text.empty())
+        {
+            std::size_t start = added_.size();
+            scan::find_all(text.data(), text.size(), break_char_, start, added_breaks_);
+            added_.append(text);
+
+            // Typing extends the piece of the previous insertion
+            piece *prev = first > 0 ? &pieces_[first - 1] : nullptr;
+            if (prev && prev->added && prev->start + prev->length == start)
+                prev->length += text.size();
+            else
+                pieces_.insert(pieces_.begin() + first++, piece{true, start, text.size()});
+        }
+
+        // Rejoin neighbours that a deletion made contiguous again
+        if (first > 0 && first < pieces_.size())
+        {
+            piece &a = pieces_[first - 1];
+            const piece &b = pieces_[first];
+            if (a.added == b.added && a.start + a.length == b.start)
+            {
+                a.length += b.length;
+                pieces_.erase(pieces_.begin() + first);
+            }
+        }
+
+        refresh();
+
+        text_change c{pos, pos + length, pos + text.size()};
+        changes_.push_back(c);
+
+        // The reading position moves with the text
+        std::size_t at = pos_;
+        if (!c.shift(at))
+            at = pos;
+        seek(at);
+    }
+
+    void overlay::insert(std::size_t pos, std::string_view text)
+    {
+        replace(pos, 0, text);
+    }
+
+    void overlay::erase(std::size_t pos, std::size_t length)
+    {
+        replace(pos, length, {});
+    }
+
+    std::size_t overlay::size() const
+    {
+        return offsets_.back();
+    }
+
+    std::size_t overlay::lines() const
+    {
+        return breaks_before_.back() + 1;
+    }
+
+    int overlay::line_of(std::size_t pos) const
+    {
+        if (pieces_.empty())
+            return 1;
+
+        std::size_t k = piece_at(pos);
+        const piece &p = pieces_[k];
+        const auto &b = breaks(p);
+        std::size_t within = std::min(pos - offsets_[k], p.length);
+        auto first = std::lower_bound(b.begin(), b.end(), p.start);
+        auto upto = std::lower_bound(first, b.end(), p.start + within);
+        return static_cast<int>(breaks_before_[k] + (upto - first)) + 1;
+    }
+
+    int overlay::column_of(std::size_t pos) const
+    {
+        std::size_t start = line_start(line_of(pos));
+        int column = static_cast<int>(pos - start) + 1;
+
+        // The '\r' of a CRLF pair takes no column
+        if (endings_ == line_ending::crlf && pos < size() && pos > start &&
+            at(pos) == '\n' && at(pos - 1) == '\r')
+            --column;
+        return column;
+    }
+
+    std::size_t overlay::line_start(std::size_t line) const
+    {
+        if (line <= 1)
+            return 0;
+
+        std::size_t m = line - 1; // the break ending line - 1
+        if (m > breaks_before_.back())
+            throw std::out_of_range("Line number out of range");
+
+        // Piece k holds the m-th break: breaks_before_[k] < m <= breaks_before_[k + 1]
+        std::size_t k = std::lower_bound(breaks_before_.begin(), breaks_before_.end(), m) - breaks_before_.begin() - 1;
+        const piece &p = pieces_[k];
+        const auto &b = breaks(p);
+        auto first = std::lower_bound(b.begin(), b.end(), p.start);
+        std::size_t brk = first[m - breaks_before_[k] - 1];
+        return offsets_[k] + (brk - p.start) + 1;
+    }
+
+    std::string overlay::str() const
+    {
+        std::string out;
+        out.reserve(size());
+        for (const piece &p : pieces_)
+            out.append(buffer(p) + p.start, p.length);
+        return out;
+    }
+
+    std::size_t overlay::pieces() const
+    {
+        return pieces_.size();
+    }
+
+    std::uint32_t overlay::generation() const
+    {
+        return static_cast<std::uint32_t>(changes_.size());
+    }
+
+    text_change overlay::last_change() const
+    {
+        return changes_.empty() ? text_change{} : changes_.back();
+    }
+
+    void overlay::enter(std::size_t k, std::size_t within)
+    {
+        piece_ = k;
+        if (k < pieces_.size())
+        {
+            const piece &p = pieces_[k];
+            const char *b = buffer(p) + p.start;
+            cur_ = b + within;
+            end_ = b + p.length;
+        }
+        else
+        {
+            cur_ = end_ = nullptr;
+        }
+    }
+
+    int overlay::get()
+    {
+        // Fast path within a piece; pieces are switched only at their ends
+        if (cur_ == end_)
+        {
+            if (piece_ + 1 >= pieces_.size())
+                return EOF;
+            enter(piece_ + 1, 0);
+        }
+
+        char ch = *cur_++;
+        if (ch == break_char_)
+        {
+            ++line_;
+            column_ = 1;
+        }
+        else if (ch != '\r' || endings_ != line_ending::crlf ||
+                 !(cur_ < end_ ? *cur_ == '\n' : is_zero_width_cr(pos_)))
+        {
+            ++column_;
+        }
+        ++pos_;
+        return static_cast<unsigned char>(ch);
+    }
+
+    int overlay::peek() const
+    {
+        if (cur_ < end_)
+            return static_cast<unsigned char>(*cur_);
+        if (piece_ + 1 >= pieces_.size())
+            return EOF;
+        const piece &p = pieces_[piece_ + 1];
+        return static_cast<unsigned char>(buffer(p)[p.start]);
+    }
+
+    void overlay::putback()
+    {
+        if (pos_ == 0)
+            return;
+
+        const piece &p = pieces_[piece_];
+        if (cur_ == buffer(p) + p.start)
+            enter(piece_ - 1, pieces_[piece_ - 1].length);
+
+        char ch = *--cur_;
+        --pos_;
+        if (ch == break_char_)
+        {
+            --line_;
+            column_ = column_of(pos_);
+        }
+        else if (ch != '\r' || !is_zero_width_cr(pos_))
+        {
+            --column_;
+        }
+    }
+
+    bool overlay::is_zero_width_cr(std::size_t pos) const
+    {
+        return endings_ == line_ending::crlf && pos + 1 < size() && at(pos + 1) == '\n';
+    }
+
+    overlay::operator bool() const
+    {
+        return pos_ < size();
+    }
+
+    std::size_t overlay::position() const
+    {
+        return pos_;
+    }
+
+    int overlay::line() const
+    {
+        return line_;
+    }
+
+    int overlay::column() const
+    {
+        return column_;
+    }
+
+    bookmark overlay::mark() const
+    {
+        return bookmark(pos_, line_, column_, generation());
+    }
+
+    void overlay::seek(const bookmark &b)
+    {
+        if (b.generation() == generation())
+        {
+            std::size_t k = piece_at(b.position());
+            enter(k, pieces_.empty() ? 0 : b.position() - offsets_[k]);
+            pos_ = b.position();
+            line_ = b.line();
+            column_ = b.column();
+            return;
+        }
+
+        std::size_t pos = b.position();
+        for (std::size_t g = b.generation(); g < changes_.size(); ++g)
+            if (!changes_[g].shift(pos))
+                throw std::invalid_argument("overlay: bookmark refers to text that has been replaced");
+        seek(pos);
+    }
+
+    void overlay::seek(std::size_t pos)
+    {
+        pos = std::min(pos, size());
+        std::size_t k = piece_at(pos);
+        enter(k, pieces_.empty() ? 0 : pos - offsets_[k]);
+        pos_ = pos;
+        line_ = line_of(pos);
+        column_ = column_of(pos);
+    }
+
+} // namespace mms
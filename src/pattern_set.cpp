@@ -0,0 +1,173 @@
+/// \file
+/// \brief Implementation of the `mms::pattern_set` class, a multi-keyword matcher.
+///
+/// The keywords are stored in a trie which is then completed into an
+/// Aho-Corasick automaton: every state has a transition for every byte
+/// class, so the search does one table lookup per byte and never follows
+/// failure links. Bytes that occur in no keyword share class 0.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <deque>
+#include <stdexcept>
+
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    pattern_set::pattern_set(std::initializer_list<std::string_view> patterns)
+    {
+        for (std::string_view p : patterns)
+            patterns_.emplace_back(p);
+        build();
+    }
+
+    pattern_set::pattern_set(const std::vector<std::string> &patterns)
+        : patterns_(patterns)
+    {
+        build();
+    }
+
+    void pattern_set::build()
+    {
+        classes_.fill(0);
+        class_count_ = 1;
+        for (const std::string &p : patterns_)
+        {
+            if (p.empty())
+                throw std::invalid_argument("pattern_set: empty pattern");
+            for (unsigned char ch : p)
+                if (classes_[ch] == 0)
+                    classes_[ch] = static_cast<std::uint16_t>(class_count_++);
+        }
+
+        // Trie; a zero transition means "no child" until the automaton is completed
+        const std::size_t classes = class_count_;
+        next_.assign(classes, 0);
+        depth_.assign(1, 0);
+        longest_.assign(1, -1);
+        for (std::size_t k = 0; k < patterns_.size(); ++k)
+        {
+            std::uint32_t s = 0;
+            for (unsigned char ch : patterns_[k])
+            {
+                std::uint32_t &t = next_[s * classes + classes_[ch]];
+                if (t == 0)
+                {
+                    std::uint32_t child = static_cast<std::uint32_t>(depth_.size());
+                    depth_.push_back(depth_[s] + 1);
+                    longest_.push_back(-1);
+                    next_[s * classes + classes_[ch]] = child;
+                    next_.resize(next_.size() + classes, 0);
+                    s = child;
+                }
+                else
+                {
+                    s = t;
+                }
+            }
+            if (longest_[s] < 0) // the first of duplicate patterns wins
+                longest_[s] = static_cast<std::int32_t>(k);
+        }
+
+        // Breadth-first: failure links, then missing transitions borrowed from them
+        std::vector<std::uint32_t> fail(depth_.size(), 0);
+        std::deque<std::uint32_t> queue;
+        for (std::size_t c = 0; c < classes; ++c)
+            if (next_[c])
+                queue.push_back(next_[c]);
+
+        while (!queue.empty())
+        {
+            std::uint32_t s = queue.front();
+            queue.pop_front();
+
+            // A state's own pattern is the longest ending there; otherwise take its suffix's
+            if (longest_[s] < 0)
+                longest_[s] = longest_[fail[s]];
+
+            for (std::size_t c = 0; c < classes; ++c)
+            {
+                std::uint32_t t = next_[s * classes + c];
+                std::uint32_t via_fail = next_[fail[s] * classes + c];
+                if (t && depth_[t] == depth_[s] + 1)
+                {
+                    fail[t] = via_fail;
+                    queue.push_back(t);
+                }
+                else
+                {
+                    next_[s * classes + c] = via_fail;
+                }
+            }
+        }
+
+        // Skip ahead at the root only when a vectorized scan can cover all first bytes
+        first_bytes_.clear();
+        for (const std::string &p : patterns_)
+            if (first_bytes_.find(p[0]) == std::string::npos)
+                first_bytes_ += p[0];
+        if (first_bytes_.size() > 3)
+            first_bytes_.clear();
+    }
+
+    std::size_t pattern_set::size() const
+    {
+        return patterns_.size();
+    }
+
+    std::string_view pattern_set::pattern(std::size_t i) const
+    {
+        return patterns_.at(i);
+    }
+
+    std::size_t pattern_set::find(std::string_view text, std::size_t from,
+                                  std::size_t &length, std::size_t &pattern) const
+    {
+        constexpr std::size_t none = std::string_view::npos;
+        if (patterns_.empty())
+            return none;
+
+        const char *data = text.data();
+        const std::size_t size = text.size();
+        const std::size_t classes = class_count_;
+        std::size_t best = none;
+        std::uint32_t state = 0;
+
+        for (std::size_t i = from; i < size; ++i)
+        {
+            if (state == 0 && !first_bytes_.empty())
+            {
+                i += scan::find_first_of(data + i, size - i, first_bytes_.data(), first_bytes_.size());
+                if (i == size)
+                    break;
+            }
+
+            state = next_[state * classes + classes_[static_cast<unsigned char>(data[i])]];
+
+            // Once the partial match starts after the best match, nothing can start earlier
+            std::size_t start = i + 1 - depth_[state];
+            if (best != none && start > best)
+                break;
+
+            std::int32_t p = longest_[state];
+            if (p >= 0)
+            {
+                std::size_t len = patterns_[p].size();
+                std::size_t at = i + 1 - len;
+                if (best == none || at < best || (at == best && len > length))
+                {
+                    best = at;
+                    length = len;
+                    pattern = static_cast<std::size_t>(p);
+                }
+            }
+        }
+        return best;
+    }
+
+} // namespace mms
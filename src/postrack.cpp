@@ -3,28 +3,65 @@
 ///
 /// This file defines the `postrack` class, which manages the tracking of byte position,
 /// line, and column numbers in a character stream. It supports putback correction,
-/// bookmarking for fast seeks, and newline indexing.
+/// bookmarking for fast seeks, and newline indexing. Columns are counted in
+/// bytes or, on request, in UTF-8 code points with checkpoints along long lines.
 ///
 /// Copyright (c) 2024–2025 Tomaz Stih
 /// SPDX-License-Identifier: MIT
 
+#include <algorithm>
+#include <iterator>
+
 #include <mms/mms.h>
 
+#include "scan.h"
+
 namespace mms
 {
 
-    postrack::postrack()
-        : line_(1), column_(1), current_pos_(0) {}
+    postrack::postrack(line_ending endings)
+        : line_(1), column_(1), current_pos_(0),
+          endings_(endings), break_char_(endings == line_ending::cr ? '\r' : '\n'),
+          data_(nullptr), size_(0),
+          unit_(column_unit::bytes), interval_(4096),
+          next_checkpoint_(4096) {}
+
+    void postrack::attach(const char *data, std::size_t size)
+    {
+        data_ = data;
+        size_ = size;
+        if (endings_ == line_ending::detect)
+        {
+            endings_ = detect_line_ending(data, size);
+            break_char_ = endings_ == line_ending::cr ? '\r' : '\n';
+        }
+    }
+
+    line_ending postrack::endings() const
+    {
+        return endings_ == line_ending::detect ? line_ending::lf : endings_;
+    }
 
     void postrack::update_position(int ch)
     {
-        if (ch == '\n')
+        if (ch == break_char_)
         {
             newline_positions_.insert(current_pos_);
             ++line_;
             column_ = 1;
+            next_checkpoint_ = current_pos_ + 1 + interval_;
         }
-        else
+        else if (unit_ == column_unit::code_points)
+        {
+            if (current_pos_ == next_checkpoint_)
+            {
+                checkpoints_[current_pos_] = column_;
+                next_checkpoint_ += interval_;
+            }
+            if ((ch & 0xC0) != 0x80 && (ch != '\r' || !is_zero_width_cr(current_pos_)))
+                ++column_;
+        }
+        else if (ch != '\r' || !is_zero_width_cr(current_pos_))
         {
             ++column_;
         }
@@ -35,21 +72,16 @@ namespace mms
     {
         --current_pos_;
 
-        if (c == '\n')
+        if (c == break_char_)
         {
             --line_;
-            auto it = newline_positions_.lower_bound(current_pos_);
-            if (it == newline_positions_.begin())
-            {
-                column_ = current_pos_ + 1;
-            }
-            else
-            {
-                --it;
-                column_ = current_pos_ - *it;
-            }
+            column_ = column_at(current_pos_);
         }
-        else
+        else if (unit_ == column_unit::code_points && (c & 0xC0) == 0x80)
+        {
+            // A continuation byte took no column
+        }
+        else if (c != '\r' || !is_zero_width_cr(current_pos_))
         {
             --column_;
         }
@@ -58,6 +90,8 @@ namespace mms
     void postrack::set_position(std::size_t pos)
     {
         current_pos_ = pos;
+        auto nl = newline_positions_.lower_bound(pos);
+        std::size_t start = nl == newline_positions_.begin() ? 0 : *std::prev(nl) + 1;
 
         // Check if the position is bookmarked
         auto it = bookmarks_.find(pos);
@@ -69,21 +103,74 @@ namespace mms
         else
         {
             // Recalculate line and column for non-bookmarked positions
-            line_ = 1;
-            column_ = 1;
-            for (auto newline_pos : newline_positions_)
+            line_ = 1 + static_cast<int>(std::distance(newline_positions_.begin(), nl));
+            column_ = column_from(start, pos);
+        }
+        sync_checkpoint(start);
+    }
+
+    void postrack::sync_checkpoint(std::size_t line_start)
+    {
+        // The first checkpoint of the line at or after the current position
+        std::size_t k = (current_pos_ - line_start + interval_ - 1) / interval_;
+        next_checkpoint_ = line_start + std::max<std::size_t>(k, 1) * interval_;
+    }
+
+    bool postrack::is_zero_width_cr(std::size_t pos) const
+    {
+        if (endings_ != line_ending::crlf)
+            return false;
+        if (!data_)
+            return true; // Cannot look ahead; assume it is part of a CRLF
+        return pos + 1 < size_ && data_[pos + 1] == '\n';
+    }
+
+    int postrack::column_at(std::size_t pos) const
+    {
+        auto it = newline_positions_.lower_bound(pos);
+        std::size_t line_start = 0;
+        if (it != newline_positions_.begin())
+            line_start = *std::prev(it) + 1;
+        return column_from(line_start, pos);
+    }
+
+    int postrack::column_from(std::size_t line_start, std::size_t pos) const
+    {
+        int column;
+        if (unit_ == column_unit::bytes || !data_)
+        {
+            column = static_cast<int>(pos - line_start) + 1;
+        }
+        else
+        {
+            // Start from the nearest checkpoint of this line
+            std::size_t from = line_start;
+            column = 1;
+            auto it = checkpoints_.upper_bound(pos);
+            if (it != checkpoints_.begin() && std::prev(it)->first >= line_start)
+            {
+                --it;
+                from = it->first;
+                column = it->second;
+            }
+
+            // Record the checkpoints passed on the way
+            std::size_t next = line_start + ((from - line_start) / interval_ + 1) * interval_;
+            for (; next <= pos; next += interval_)
             {
-                if (newline_pos < pos)
-                {
-                    ++line_;
-                    column_ = pos - newline_pos; // Calculate the column correctly
-                }
-                else
-                {
-                    break;
-                }
+                column += static_cast<int>(scan::count_code_points(data_ + from, next - from));
+                checkpoints_[next] = column;
+                from = next;
             }
+            column += static_cast<int>(scan::count_code_points(data_ + from, pos - from));
         }
+
+        // The '\r' of a CRLF pair before a break took no column
+        if (pos > line_start && is_zero_width_cr(pos - 1) &&
+            (data_ ? data_[pos - 1] == '\r' : newline_positions_.count(pos) != 0))
+            --column;
+
+        return column;
     }
 
     bookmark postrack::add_bookmark()
@@ -93,11 +180,18 @@ namespace mms
         return b;
     }
 
+    bool postrack::has_bookmark(std::size_t pos) const
+    {
+        return bookmarks_.count(pos) != 0;
+    }
+
     void postrack::set_position(const bookmark &b)
     {
         current_pos_ = b.position();
         line_ = b.line();
         column_ = b.column();
+        auto nl = newline_positions_.lower_bound(current_pos_);
+        sync_checkpoint(nl == newline_positions_.begin() ? 0 : *std::prev(nl) + 1);
     }
 
     int postrack::line() const
@@ -120,4 +214,25 @@ namespace mms
         return current_pos_;
     }
 
+    void postrack::set_column_unit(column_unit unit, std::size_t checkpoint_interval)
+    {
+        if (checkpoint_interval == 0)
+            throw std::invalid_argument("postrack: checkpoint interval must not be zero");
+        unit_ = unit;
+        interval_ = checkpoint_interval;
+        checkpoints_.clear();
+        auto nl = newline_positions_.lower_bound(current_pos_);
+        sync_checkpoint(nl == newline_positions_.begin() ? 0 : *std::prev(nl) + 1);
+    }
+
+    column_unit postrack::columns() const
+    {
+        return unit_;
+    }
+
+    std::size_t postrack::checkpoint_interval() const
+    {
+        return interval_;
+    }
+
 } // namespace mms
\ No newline at end of file
@@ -0,0 +1,144 @@
+/// \file
+/// \brief Implementation of the `mms::prefetcher` class.
+///
+/// The prefetcher keeps a configurable window of a read-only mapping
+/// resident ahead of the reader, either by issuing `MADV_WILLNEED` inline or
+/// by delegating to a helper thread that also touches the pages. Residency
+/// is sampled with `mincore` before each request so the number of major
+/// faults taken off the reader's path can be reported.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <unistd.h>   // sysconf
+#include <sys/mman.h> // madvise, mincore
+
+#include <algorithm>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    prefetcher::prefetcher(const char *data, std::size_t size, const prefetch_options &opts)
+        : data_(data), size_(size), options_(opts),
+          page_size_(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+          prefetched_to_(0),
+          requests_(0), pages_advised_(0), faults_absorbed_(0),
+          target_(0), pending_(false), stopping_(false)
+    {
+        if (options_.step == 0)
+            options_.step = page_size_;
+        if (options_.distance < options_.step)
+            options_.distance = options_.step;
+
+        residency_.resize(options_.distance / page_size_ + 2);
+
+        if (options_.mode == prefetch_mode::thread)
+            worker_ = std::thread([this]
+                                  { run(); });
+    }
+
+    prefetcher::~prefetcher()
+    {
+        if (worker_.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_one();
+            worker_.join();
+        }
+    }
+
+    void prefetcher::advance(std::size_t pos)
+    {
+        if (options_.mode == prefetch_mode::thread)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                target_ = pos;
+                pending_ = true;
+            }
+            wake_.notify_one();
+        }
+        else if (options_.mode == prefetch_mode::advise)
+        {
+            issue(pos);
+        }
+    }
+
+    const prefetch_options &prefetcher::options() const
+    {
+        return options_;
+    }
+
+    prefetch_stats prefetcher::stats() const
+    {
+        prefetch_stats s;
+        s.requests = requests_.load(std::memory_order_relaxed);
+        s.pages_advised = pages_advised_.load(std::memory_order_relaxed);
+        s.faults_absorbed = faults_absorbed_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void prefetcher::issue(std::size_t pos)
+    {
+        // Only request what has not been requested already; after a backward
+        // seek the window restarts from the new position.
+        std::size_t from = pos < prefetched_to_ && prefetched_to_ <= pos + options_.distance
+                               ? prefetched_to_
+                               : pos;
+        std::size_t to = std::min(size_, pos + options_.distance);
+        if (from >= to)
+            return;
+
+        // madvise and mincore need page-aligned addresses
+        std::size_t first = from / page_size_ * page_size_;
+        std::size_t length = to - first;
+        std::size_t pages = (length + page_size_ - 1) / page_size_;
+        char *addr = const_cast<char *>(data_) + first;
+
+        std::size_t missing = 0;
+        if (pages <= residency_.size() && mincore(addr, length, residency_.data()) == 0)
+        {
+            for (std::size_t i = 0; i < pages; ++i)
+                missing += (residency_[i] & 1) == 0;
+        }
+
+        madvise(addr, length, MADV_WILLNEED);
+
+        // The helper thread takes the faults itself so the reader does not
+        if (options_.mode == prefetch_mode::thread && missing > 0)
+        {
+            volatile char sink = 0;
+            for (std::size_t off = first; off < to; off += page_size_)
+                sink = sink + data_[off];
+        }
+
+        prefetched_to_ = to;
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        pages_advised_.fetch_add(pages, std::memory_order_relaxed);
+        faults_absorbed_.fetch_add(missing, std::memory_order_relaxed);
+    }
+
+    void prefetcher::run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            wake_.wait(lock, [this]
+                       { return stopping_ || pending_; });
+            if (stopping_)
+                return;
+
+            std::size_t pos = target_;
+            pending_ = false;
+            lock.unlock();
+            issue(pos);
+            lock.lock();
+        }
+    }
+
+} // namespace mms
@@ -0,0 +1,196 @@
+/// \file
+/// \brief Implementation of the `mms::record_scanner` class, a delimited-record reader.
+///
+/// Each 64-byte block is reduced to bit masks: one for quotes, one for
+/// field separators and one for line breaks. A bit in the prefix XOR of the
+/// quote mask is set exactly for the bytes between an opening and a closing
+/// quote (doubled quotes toggle twice and cancel), so separators and breaks
+/// under it are discarded. What remains are the structural positions of the
+/// block, consumed one set bit at a time.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    namespace
+    {
+        constexpr std::size_t block_size = 64;
+
+        // Bit i is set if an odd number of bits 0..i of x are set
+        inline std::uint64_t prefix_xor(std::uint64_t x)
+        {
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+        }
+    } // namespace
+
+    record_scanner::record_scanner(const source &src, const record_options &opts)
+        : record_scanner(std::string_view(src.data(), src.size()), opts, src.endings()) {}
+
+    record_scanner::record_scanner(std::string_view text, const record_options &opts, line_ending endings)
+        : text_(text.data()), size_(text.size()), options_(opts),
+          break_char_(endings == line_ending::cr ? '\r' : '\n'),
+          block_(0), structural_(0), breaks_(0), inside_(0),
+          pos_(0), next_line_(1), line_(0), offset_(0), quoted_(false)
+    {
+        if (options_.whitespace)
+            options_.quote = '\0';
+        load_block();
+    }
+
+    void record_scanner::load_block()
+    {
+        const char *p = text_ + block_;
+        std::size_t avail = size_ - block_;
+        char padded[block_size];
+        if (avail < block_size)
+        {
+            std::memset(padded, 0, block_size);
+            if (avail)
+                std::memcpy(padded, p, avail);
+            p = padded;
+        }
+
+        std::uint64_t breaks = scan::mask64(p, break_char_);
+        std::uint64_t separators;
+        if (options_.whitespace)
+        {
+            separators = scan::mask64(p, ' ') | scan::mask64(p, '\t');
+            if (break_char_ == '\n')
+                separators |= scan::mask64(p, '\r');
+        }
+        else
+        {
+            separators = scan::mask64(p, options_.delimiter);
+        }
+
+        std::uint64_t inside = 0;
+        if (options_.quote)
+        {
+            inside = prefix_xor(scan::mask64(p, options_.quote)) ^ (0 - inside_);
+            inside_ = inside >> 63;
+        }
+
+        std::uint64_t valid = avail < block_size ? (std::uint64_t{1} << avail) - 1 : ~std::uint64_t{0};
+        structural_ = (separators | breaks) & ~inside & valid;
+        breaks_ = breaks & ~inside & valid;
+    }
+
+    void record_scanner::add_field(std::size_t start, std::size_t end)
+    {
+        if (options_.whitespace)
+        {
+            // Runs of blanks separate fields, so the empty fields between them are not data
+            if (start < end)
+                fields_.push_back(field{false, start, end - start});
+            return;
+        }
+
+        const char q = options_.quote;
+        if (q && start < end && text_[start] == q)
+        {
+            quoted_ = true;
+            ++start;
+            if (end > start && text_[end - 1] == q)
+                --end;
+
+            const char *f = text_ + start;
+            std::size_t n = end - start;
+            if (std::memchr(f, q, n))
+            {
+                // Collapse doubled quotes
+                std::size_t at = scratch_.size();
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    scratch_ += f[i];
+                    if (f[i] == q && i + 1 < n && f[i + 1] == q)
+                        ++i;
+                }
+                fields_.push_back(field{true, at, scratch_.size() - at});
+                return;
+            }
+        }
+        fields_.push_back(field{false, start, end - start});
+    }
+
+    void record_scanner::not_a_number(std::size_t i) const
+    {
+        throw std::invalid_argument("record_scanner: field " + std::to_string(i + 1) + " on line " +
+                                    std::to_string(line_) + " is not a number: " + std::string(views_[i]));
+    }
+
+    bool record_scanner::next()
+    {
+        while (pos_ < size_)
+        {
+            fields_.clear();
+            scratch_.clear();
+            quoted_ = false;
+            offset_ = pos_;
+            line_ = next_line_;
+
+            std::size_t start = pos_, end = size_;
+            bool at_break = false;
+            for (;;)
+            {
+                while (!structural_ && block_ + block_size < size_)
+                {
+                    block_ += block_size;
+                    load_block();
+                }
+                if (!structural_)
+                    break;
+
+                std::uint64_t bit = structural_ & (0 - structural_);
+                structural_ ^= bit;
+                std::size_t p = block_ + __builtin_ctzll(bit);
+                if (breaks_ & bit)
+                {
+                    end = p;
+                    at_break = true;
+                    break;
+                }
+                add_field(start, p);
+                start = p + 1;
+            }
+
+            // The '\r' of a CRLF ending belongs to the break, not the last field
+            std::size_t last = end;
+            if (break_char_ == '\n' && last > start && text_[last - 1] == '\r')
+                --last;
+            add_field(start, last);
+
+            pos_ = at_break ? end + 1 : size_;
+            next_line_ += at_break;
+            if (quoted_)
+                next_line_ += scan::count(text_ + offset_, end - offset_, break_char_);
+
+            if (options_.skip_empty && !quoted_ &&
+                (fields_.empty() || (fields_.size() == 1 && fields_[0].length == 0)))
+                continue;
+
+            views_.clear();
+            for (const field &f : fields_)
+                views_.emplace_back((f.unescaped ? scratch_.data() : text_) + f.start, f.length);
+            return true;
+        }
+        views_.clear();
+        return false;
+    }
+
+} // namespace mms
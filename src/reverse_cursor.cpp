@@ -0,0 +1,104 @@
+/// \file
+/// \brief Implementation of the `mms::reverse_cursor` class, a backwards line reader.
+///
+/// Stepping back a line is one reverse byte search for the break before
+/// it. Line numbers are the only thing that needs the text before the
+/// cursor; they are counted once, splitting large texts into a slice per
+/// hardware thread, and then kept up to date by decrementing.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <numeric>
+
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    namespace
+    {
+        /// Smallest slice worth counting on a separate thread
+        constexpr std::size_t parallel_slice = 4 * 1024 * 1024;
+
+        std::size_t count_breaks(const char *data, std::size_t size, char c)
+        {
+            std::size_t threads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                        size / parallel_slice);
+            if (threads < 2)
+                return scan::count(data, size, c);
+
+            std::vector<std::size_t> counts(threads);
+            std::vector<std::thread> workers;
+            std::size_t slice = size / threads;
+            for (std::size_t t = 1; t < threads; ++t)
+            {
+                std::size_t from = t * slice;
+                std::size_t len = t + 1 == threads ? size - from : slice;
+                workers.emplace_back([&counts, t, data, from, len, c]
+                                     { counts[t] = scan::count(data + from, len, c); });
+            }
+            counts[0] = scan::count(data, slice, c);
+            for (auto &w : workers)
+                w.join();
+            return std::accumulate(counts.begin(), counts.end(), std::size_t{0});
+        }
+    } // namespace
+
+    reverse_cursor::reverse_cursor(const source &src)
+        : reverse_cursor(std::string_view(src.data(), src.size()), src.endings()) {}
+
+    reverse_cursor::reverse_cursor(std::string_view text, line_ending endings)
+        : data_(text.data()), size_(text.size()),
+          endings_(endings == line_ending::detect ? detect_line_ending(text.data(), text.size()) : endings),
+          break_char_(endings_ == line_ending::cr ? '\r' : '\n'),
+          end_(text.size()) {}
+
+    std::optional<std::string_view> reverse_cursor::previous()
+    {
+        if (end_ == 0)
+            return std::nullopt;
+
+        // The break ending this line (a final break ends the last line, not an empty one)
+        std::size_t text_end = end_;
+        if (data_[end_ - 1] == break_char_)
+            --text_end;
+
+        std::size_t brk = scan::rfind(data_, text_end, break_char_);
+        std::size_t start = brk == text_end ? 0 : brk + 1;
+        std::string_view text(data_ + start, text_end - start);
+        if (endings_ == line_ending::crlf && !text.empty() && text.back() == '\r')
+            text.remove_suffix(1);
+
+        end_ = start;
+        if (line_)
+            --*line_;
+        return text;
+    }
+
+    std::vector<std::string_view> reverse_cursor::tail(std::size_t n)
+    {
+        std::vector<std::string_view> lines;
+        lines.reserve(std::min<std::size_t>(n, 1024));
+        while (lines.size() < n)
+        {
+            auto line = previous();
+            if (!line)
+                break;
+            lines.push_back(*line);
+        }
+        std::reverse(lines.begin(), lines.end());
+        return lines;
+    }
+
+    std::size_t reverse_cursor::line() const
+    {
+        if (!line_)
+            line_ = count_breaks(data_, end_, break_char_) + 1;
+        return *line_;
+    }
+
+} // namespace mms
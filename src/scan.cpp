@@ -0,0 +1,245 @@
+/// \file
+/// \brief Implementation of the internal byte-scanning primitives.
+///
+/// Each routine compares 16-byte blocks against a broadcast byte and walks
+/// the resulting bit mask, so the cost per byte is independent of how often
+/// the byte occurs. A scalar loop handles the tail and non-SSE2 targets.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include "scan.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace mms::scan
+{
+
+#if defined(__SSE2__)
+    namespace
+    {
+        inline unsigned match_mask(const char *p, __m128i needle)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        }
+    } // namespace
+#endif
+
+    void find_all(const char *data, std::size_t size, char c,
+                  std::size_t base, std::vector<std::size_t> &out)
+    {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(c);
+        for (; i + 16 <= size; i += 16)
+        {
+            unsigned mask = match_mask(data + i, needle);
+            while (mask)
+            {
+                out.push_back(base + i + __builtin_ctz(mask));
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < size; ++i)
+            if (data[i] == c)
+                out.push_back(base + i);
+    }
+
+    std::size_t count(const char *data, std::size_t size, char c)
+    {
+        std::size_t n = 0;
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(c);
+        for (; i + 16 <= size; i += 16)
+            n += __builtin_popcount(match_mask(data + i, needle));
+#endif
+        for (; i < size; ++i)
+            n += data[i] == c;
+        return n;
+    }
+
+    std::size_t rfind(const char *data, std::size_t size, char c)
+    {
+        std::size_t i = size;
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(c);
+        for (; i >= 16; i -= 16)
+        {
+            unsigned mask = match_mask(data + i - 16, needle);
+            if (mask)
+                return i - 16 + (31 - __builtin_clz(mask));
+        }
+#endif
+        while (i > 0)
+            if (data[--i] == c)
+                return i;
+        return size;
+    }
+
+    std::size_t count_code_points(const char *data, std::size_t size)
+    {
+        std::size_t continuation = 0;
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        // Continuation bytes 0x80-0xBF are exactly the signed bytes below -64
+        const __m128i limit = _mm_set1_epi8(-64);
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            continuation += __builtin_popcount(_mm_movemask_epi8(_mm_cmplt_epi8(block, limit)));
+        }
+#endif
+        for (; i < size; ++i)
+            continuation += (static_cast<unsigned char>(data[i]) & 0xC0) == 0x80;
+        return size - continuation;
+    }
+
+    ending_counts count_endings(const char *data, std::size_t size)
+    {
+        std::size_t lf = 0, cr = 0, crlf = 0;
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i nl = _mm_set1_epi8('\n');
+        const __m128i ret = _mm_set1_epi8('\r');
+        unsigned carry = 0; // 1 if the previous block ended with '\r'
+        for (; i + 16 <= size; i += 16)
+        {
+            unsigned n = match_mask(data + i, nl);
+            unsigned r = match_mask(data + i, ret);
+            lf += __builtin_popcount(n);
+            cr += __builtin_popcount(r);
+            // A pair is a '\r' whose successor is '\n'
+            crlf += __builtin_popcount((((r << 1) | carry) & n) & 0xFFFF);
+            carry = (r >> 15) & 1;
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            if (data[i] == '\n')
+            {
+                ++lf;
+                if (i > 0 && data[i - 1] == '\r')
+                    ++crlf;
+            }
+            else if (data[i] == '\r')
+            {
+                ++cr;
+            }
+        }
+
+        ending_counts e;
+        e.crlf = crlf;
+        e.lf = lf - crlf;
+        e.cr = cr - crlf;
+        return e;
+    }
+
+    std::uint64_t mask64(const char *data, char c)
+    {
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(c);
+        return static_cast<std::uint64_t>(match_mask(data, needle)) |
+               static_cast<std::uint64_t>(match_mask(data + 16, needle)) << 16 |
+               static_cast<std::uint64_t>(match_mask(data + 32, needle)) << 32 |
+               static_cast<std::uint64_t>(match_mask(data + 48, needle)) << 48;
+#else
+        std::uint64_t mask = 0;
+        for (unsigned i = 0; i < 64; ++i)
+            mask |= static_cast<std::uint64_t>(data[i] == c) << i;
+        return mask;
+#endif
+    }
+
+    std::size_t find(const char *data, std::size_t size, const char *needle, std::size_t n)
+    {
+        if (n == 0)
+            return 0;
+        if (n > size)
+            return size;
+
+        const std::size_t last = size - n; // last possible start
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i ending = _mm_set1_epi8(needle[n - 1]);
+        for (; i + 16 <= last + 1; i += 16)
+        {
+            unsigned mask = match_mask(data + i, first) & match_mask(data + i + n - 1, ending);
+            while (mask)
+            {
+                std::size_t at = i + __builtin_ctz(mask);
+                if (std::memcmp(data + at + 1, needle + 1, n - 1) == 0)
+                    return at;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i <= last; ++i)
+            if (data[i] == needle[0] && std::memcmp(data + i + 1, needle + 1, n - 1) == 0)
+                return i;
+        return size;
+    }
+
+    std::size_t find_first_of(const char *data, std::size_t size, const char *set, std::size_t n)
+    {
+        const char a = set[0], b = set[n > 1 ? 1 : 0], c = set[n > 2 ? 2 : 0];
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)),
+                                       _mm_cmpeq_epi8(block, vc));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+#endif
+        for (; i < size; ++i)
+            if (data[i] == a || data[i] == b || data[i] == c)
+                return i;
+        return size;
+    }
+
+    void byteswap(const char *src, char *dst, std::size_t count, std::size_t width)
+    {
+        std::size_t size = count * width;
+        std::size_t i = 0;
+        if (width == 1)
+        {
+            std::memcpy(dst, src, size);
+            return;
+        }
+#if defined(__SSE2__)
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            // Swap the bytes of each 16-bit word, then reverse the words of each value
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            if (width == 4)
+            {
+                v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+                v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            else if (width == 8)
+            {
+                v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+                v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+        }
+#endif
+        for (; i < size; i += width)
+            for (std::size_t b = 0; b < width; ++b)
+                dst[i + b] = src[i + width - 1 - b];
+    }
+
+} // namespace mms::scan
@@ -0,0 +1,59 @@
+/// \file
+/// \brief Internal byte-scanning primitives shared by the library.
+///
+/// These routines locate and count bytes in large buffers 16 bytes at a time
+/// using SSE2 where available, with portable scalar fallbacks. They are not
+/// part of the public interface.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mms::scan
+{
+    /// \brief Append `base + i` for every `data[i] == c` to \p out, in order.
+    void find_all(const char *data, std::size_t size, char c,
+                  std::size_t base, std::vector<std::size_t> &out);
+
+    /// \return Number of bytes equal to \p c in [data, data + size)
+    std::size_t count(const char *data, std::size_t size, char c);
+
+    /// \return Offset of the last byte equal to \p c in [data, data + size), or \p size if there is none
+    std::size_t rfind(const char *data, std::size_t size, char c);
+
+    /// \return Number of UTF-8 code points (bytes that are not continuation bytes) in [data, data + size)
+    std::size_t count_code_points(const char *data, std::size_t size);
+
+    /// \brief Counts of the three line terminator forms in a buffer.
+    struct ending_counts
+    {
+        std::size_t lf = 0;   ///< '\n' not preceded by '\r'
+        std::size_t cr = 0;   ///< '\r' not followed by '\n'
+        std::size_t crlf = 0; ///< "\r\n" pairs
+    };
+
+    /// \brief Count LF, CR and CRLF terminators in [data, data + size).
+    ending_counts count_endings(const char *data, std::size_t size);
+
+    /// \return Bit i set for every `data[i] == c`, i < 64; \p data must hold 64 bytes
+    std::uint64_t mask64(const char *data, char c);
+
+    /// \brief Find the first occurrence of [needle, needle + n) in [data, data + size).
+    ///
+    /// Positions whose first and last byte both match are found 16 at a
+    /// time and only those are compared in full.
+    /// \return Offset of the occurrence, or \p size if there is none
+    std::size_t find(const char *data, std::size_t size, const char *needle, std::size_t n);
+
+    /// \brief Find the first byte in [data, data + size) equal to any of \p n (1 to 3) bytes of \p set.
+    /// \return Offset of the byte, or \p size if there is none
+    std::size_t find_first_of(const char *data, std::size_t size, const char *set, std::size_t n);
+
+    /// \brief Copy \p count values of \p width (1, 2, 4 or 8) bytes from \p src to \p dst, reversing the bytes of each.
+    void byteswap(const char *src, char *dst, std::size_t count, std::size_t width);
+
+} // namespace mms::scan
@@ -0,0 +1,225 @@
+/// \file
+/// \brief Implementation of the `mms::sink` class, a memory-mapped file writer.
+///
+/// The output file is extended in fixed extents with `fallocate` (or
+/// `ftruncate` where preallocation is not supported) and a writable
+/// window over the current extent is mapped with `mmap`. Bytes are
+/// written directly into the window; when it is full, the next extent is
+/// mapped. On close the last window is flushed and the file is truncated
+/// to the number of bytes actually written.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <fcntl.h>    // open, fallocate
+#include <unistd.h>   // close, ftruncate, sysconf
+#include <sys/mman.h> // mmap, munmap, msync
+#include <cerrno>
+#include <cstring>   // strerror
+#include <stdexcept> // std::ios_base::failure
+
+#include <mms/mms.h>
+
+#include "scan.h"
+
+namespace mms
+{
+
+    namespace
+    {
+        std::size_t page_size()
+        {
+            static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        [[noreturn]] void fail(const char *what)
+        {
+            throw std::ios_base::failure(std::string(what) + ": " + strerror(errno));
+        }
+    }
+
+    sink::sink(const char *filename, line_ending endings, std::size_t extent)
+        : fd_(-1), extent_(extent), capacity_(0), window_(nullptr),
+          window_offset_(0), window_size_(0), reserved_(0), size_(0),
+          line_(1), column_(1), break_char_(endings == line_ending::cr ? '\r' : '\n')
+    {
+        // Extents are whole pages
+        std::size_t page = page_size();
+        extent_ = extent_ < page ? page : (extent_ + page - 1) / page * page;
+
+        fd_ = open(filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ == -1)
+            fail("Error creating file");
+    }
+
+    sink::~sink()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+            // Destructors must not throw; call close() to see errors
+        }
+    }
+
+    void sink::map_window(std::size_t n)
+    {
+        if (window_)
+        {
+            munmap(window_, window_size_);
+            window_ = nullptr;
+        }
+
+        // Start at the page holding the next byte; cover at least n bytes
+        std::size_t page = page_size();
+        std::size_t offset = size_ / page * page;
+        std::size_t needed = size_ - offset + n;
+        std::size_t length = needed <= extent_ ? extent_ : (needed + page - 1) / page * page;
+
+        if (offset + length > capacity_)
+        {
+            std::size_t grow = offset + length - capacity_;
+            int rc = -1;
+#if defined(__linux__)
+            rc = fallocate(fd_, 0, static_cast<off_t>(capacity_), static_cast<off_t>(grow));
+#endif
+            if (rc != 0 && ftruncate(fd_, static_cast<off_t>(offset + length)) != 0)
+                fail("Error extending file");
+            capacity_ = offset + length;
+        }
+
+        void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, static_cast<off_t>(offset));
+        if (p == MAP_FAILED)
+            fail("Error mapping file");
+        window_ = static_cast<char *>(p);
+        window_offset_ = offset;
+        window_size_ = length;
+    }
+
+    std::span<char> sink::reserve(std::size_t n)
+    {
+        if (fd_ == -1)
+            throw std::logic_error("sink: write after close");
+        if (!window_ || size_ + n > window_offset_ + window_size_)
+            map_window(n);
+        reserved_ = n;
+        return std::span<char>(window_ + (size_ - window_offset_), n);
+    }
+
+    void sink::commit(std::size_t n)
+    {
+        if (n > reserved_)
+            throw std::out_of_range("sink: commit beyond reserved space");
+
+        const char *data = window_ + (size_ - window_offset_);
+        std::size_t breaks = scan::count(data, n, break_char_);
+        if (breaks)
+        {
+            line_ += static_cast<int>(breaks);
+            std::size_t last = n;
+            while (data[last - 1] != break_char_)
+                --last;
+            column_ = static_cast<int>(n - last) + 1;
+        }
+        else
+        {
+            column_ += static_cast<int>(n);
+        }
+
+        size_ += n;
+        reserved_ = 0;
+    }
+
+    void sink::write(const char *data, std::size_t n)
+    {
+        // Large writes go through in window-sized pieces
+        while (n > 0)
+        {
+            std::size_t chunk = n < extent_ ? n : extent_;
+            std::memcpy(reserve(chunk).data(), data, chunk);
+            commit(chunk);
+            data += chunk;
+            n -= chunk;
+        }
+    }
+
+    void sink::write_hex(std::uint64_t value, int digits)
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        std::span<char> out = reserve(static_cast<std::size_t>(digits));
+        for (int i = digits - 1; i >= 0; --i, value >>= 4)
+            out[i] = hex[value & 0xF];
+        commit(static_cast<std::size_t>(digits));
+    }
+
+    void sink::pad_to_column(int column)
+    {
+        if (column <= column_)
+            return;
+        std::size_t n = static_cast<std::size_t>(column - column_);
+        std::memset(reserve(n).data(), ' ', n);
+        commit(n);
+    }
+
+    sink &sink::operator<<(std::string_view text)
+    {
+        write(text.data(), text.size());
+        return *this;
+    }
+
+    sink &sink::operator<<(const char *text)
+    {
+        return *this << std::string_view(text);
+    }
+
+    sink &sink::operator<<(char ch)
+    {
+        reserve(1)[0] = ch;
+        commit(1);
+        return *this;
+    }
+
+    std::size_t sink::size() const
+    {
+        return size_;
+    }
+
+    int sink::line() const
+    {
+        return line_;
+    }
+
+    int sink::column() const
+    {
+        return column_;
+    }
+
+    bookmark sink::mark() const
+    {
+        return bookmark(size_, line_, column_);
+    }
+
+    void sink::close()
+    {
+        if (fd_ == -1)
+            return;
+
+        int fd = fd_;
+        fd_ = -1;
+        bool ok = true;
+        if (window_)
+        {
+            ok = msync(window_, window_size_, MS_ASYNC) == 0;
+            munmap(window_, window_size_);
+            window_ = nullptr;
+        }
+        ok = ftruncate(fd, static_cast<off_t>(size_)) == 0 && ok;
+        ok = ::close(fd) == 0 && ok;
+        if (!ok)
+            fail("Error closing file");
+    }
+
+} // namespace mms
@@ -8,50 +8,165 @@
 /// Copyright (c) 2024–2025 Tomaz Stih
 /// SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <cctype>
+#include <limits>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 #include <mms/mms.h>
 
+#include "scan.h"
+
 namespace mms
 {
 
-    source::source(const char *filename)
-        : file_(filename) {}
+    namespace
+    {
+        /// Input bytes converted per chunk when transcoding
+        constexpr std::size_t decode_chunk = 64 * 1024;
+
+        /// Bytes per block when fingerprinting text for change tracking
+        constexpr std::size_t hash_block = 4096;
+
+        // Number of leading blocks with equal hashes
+        std::size_t common_blocks(const std::vector<std::uint64_t> &a, const std::vector<std::uint64_t> &b)
+        {
+            std::size_t n = std::min(a.size(), b.size());
+            return std::mismatch(a.begin(), a.begin() + n, b.begin()).first - a.begin();
+        }
+    }
+
+    source::source(const char *filename, line_ending endings, encoding enc)
+        : source(file(filename), endings, enc) {}
+
+    source::source(file f, line_ending endings, encoding enc)
+        : file_(std::move(f)), encoding_(enc), requested_(enc), bom_length_(0),
+          data_(nullptr), avail_(0), consumed_(0),
+          tracker_(endings), skipped_(false), tracking_(false),
+          splicing_(false), spliced_to_(0)
+    {
+        std::size_t bom = 0;
+        encoding found = detect_encoding(file_.data(), file_.size(), bom);
+        if (encoding_ == encoding::detect || (bom > 0 && found == encoding_))
+        {
+            encoding_ = found;
+            bom_length_ = bom;
+        }
+
+        std::size_t input = file_.size() - bom_length_;
+        if (encoding_ == encoding::utf8)
+        {
+            // Zero-copy: read the mapping in place
+            data_ = file_.data() + bom_length_;
+            avail_ = input;
+            consumed_ = input;
+        }
+        else
+        {
+            decoded_.reset(new char[utf8_capacity(encoding_, input)]);
+            data_ = decoded_.get();
+            decode_more();
+        }
+
+        horizon_ = avail_;
+        tracker_.attach(data_, avail_);
+    }
+
+    result<std::unique_ptr<source>> source::open(const char *filename, line_ending endings, encoding enc) noexcept
+    {
+        result<file> f = file::open(filename);
+        if (!f)
+            return f.error();
+        try
+        {
+            return std::make_unique<source>(std::move(*f), endings, enc);
+        }
+        catch (const std::bad_alloc &)
+        {
+            return std::make_error_code(std::errc::not_enough_memory);
+        }
+    }
+
+    source::~source()
+    {
+#if defined(MMS_STATS) && MMS_STATS
+        // Mapping size, residency and faults are sampled live by global_stats(),
+        // and index builds were added when they happened
+        source_stats s = counters_;
+        s.mapped_bytes = s.resident_bytes = s.major_faults = s.minor_faults = 0;
+        s.index_builds = s.index_build_ns = s.index_lines = 0;
+        detail::accumulate_stats(s);
+#endif
+    }
 
     int source::get()
     {
+        MMS_STAT(++counters_.gets);
         std::size_t pos = tracker_.position();
-        if (pos >= file_.size())
-            return EOF;
+        if (pos >= horizon_)
+        {
+            if (!cross_horizon(pos))
+                return EOF;
+            pos = tracker_.position(); // may have stepped over a continuation
+        }
 
-        char ch = file_.data()[pos];
+        char ch = data_[pos];
         tracker_.update_position(ch);
         return static_cast<unsigned char>(ch);
     }
 
     int source::peek() const
     {
+        MMS_STAT(++counters_.peeks);
         std::size_t pos = tracker_.position();
-        if (pos >= file_.size())
+        if (pos >= avail_ && !decode_more())
+            return EOF;
+        if (splicing_ && (pos = past_splices(pos)) >= avail_)
             return EOF;
 
-        return static_cast<unsigned char>(file_.data()[pos]);
+        return static_cast<unsigned char>(data_[pos]);
     }
 
     void source::putback()
     {
+        MMS_STAT(++counters_.putbacks);
         if (tracker_.position() > 0)
         {
-            char ch = file_.data()[tracker_.position() - 1];
+            int line = tracker_.line();
+            char ch = data_[tracker_.position() - 1];
             tracker_.adjust_position_on_putback(ch);
+
+            // Landing inside a continuation: step back over it onto the
+            // character before, and let get() find the continuation again.
+            std::size_t pos = tracker_.position();
+            for (std::size_t start; splicing_ && pos > 0 && (start = next_splice(pos)) <= pos;)
+            {
+                while (pos > start)
+                    tracker_.adjust_position_on_putback(data_[--pos]);
+                if (pos > 0)
+                    tracker_.adjust_position_on_putback(data_[--pos]);
+                horizon_ = 0;
+            }
+
+            // After a seek past unread text the tracker may not know the
+            // previous line break, so take the column from the index instead.
+            if (skipped_ && tracker_.line() != line)
+            {
+                pos = tracker_.position();
+                tracker_.set_position(bookmark(pos, tracker_.line(), resolve_column(pos)));
+            }
         }
     }
 
     source::operator bool() const
     {
-        return tracker_.position() < file_.size();
+        std::size_t pos = tracker_.position();
+        if (splicing_)
+            pos = past_splices(pos);
+        return pos < avail_ || consumed_ < file_.size() - bom_length_;
     }
 
     std::size_t source::position() const
@@ -71,91 +186,779 @@ namespace mms
 
     bookmark source::mark() const
     {
-        return bookmark(tracker_.position(), tracker_.line(), tracker_.column());
+        return bookmark(tracker_.position(), tracker_.line(), tracker_.column(), generation());
     }
 
     void source::seek(const bookmark &b)
     {
-        tracker_.set_position(b);
+        MMS_STAT(++counters_.seeks_bookmark);
+        if (splicing_)
+            horizon_ = 0; // find the next continuation from the new position
+        if (b.generation() == generation())
+        {
+            tracker_.set_position(b);
+            return;
+        }
+
+        // Taken before a reload: move it with the text
+        bookmark moved = b;
+        if (!rebase(moved))
+            throw std::invalid_argument("source: bookmark refers to text that has been replaced");
+        tracker_.set_position(moved);
+        skipped_ = true;
+    }
+
+    void source::seek(std::size_t pos)
+    {
+        if (pos > size())
+            pos = size();
+        if (splicing_)
+            horizon_ = 0; // find the next continuation from the new position
+
+        if (tracker_.has_bookmark(pos))
+        {
+            MMS_STAT(++counters_.seeks_bookmark);
+            tracker_.set_position(pos);
+            return;
+        }
+
+        // The tracker knows every newline before the furthest point read,
+        // unless an earlier seek jumped over unread text.
+        std::size_t tracked = tracker_.position();
+        const auto &newlines = tracker_.newline_positions();
+        if (!newlines.empty())
+            tracked = std::max(tracked, *newlines.rbegin() + 1);
+
+        if (!skipped_ && pos <= tracked)
+        {
+            MMS_STAT(++counters_.seeks_rescan);
+            tracker_.set_position(pos);
+            return;
+        }
+
+        MMS_STAT(++counters_.seeks_index);
+        const line_index &idx = index();
+        tracker_.set_position(bookmark(pos, idx.line_of(pos), resolve_column(pos)));
+        skipped_ = true;
+    }
+
+    const line_index &source::index() const
+    {
+        if (!index_)
+        {
+            MMS_STAT(detail::index_build_timer timer);
+            decode_all();
+            index_ = std::make_unique<line_index>(data_, avail_, tracker_.endings());
+            MMS_STAT(timer.done(index_->lines(), &counters_));
+        }
+        return *index_;
+    }
+
+    int source::resolve_column(std::size_t pos) const
+    {
+        const line_index &idx = index();
+        if (tracker_.columns() == column_unit::bytes)
+            return idx.column_of(pos);
+        return tracker_.column_from(idx.line_start(idx.line_of(pos)), pos);
+    }
+
+    void source::set_column_unit(column_unit unit, std::size_t checkpoint_interval)
+    {
+        tracker_.set_column_unit(unit, checkpoint_interval);
+        std::size_t pos = tracker_.position();
+        if (pos > 0)
+            tracker_.set_position(bookmark(pos, tracker_.line(), resolve_column(pos)));
+    }
+
+    match source::resolve(std::size_t offset, std::size_t length, std::size_t pattern) const
+    {
+        const line_index &idx = index();
+        location where{offset,
+                       static_cast<std::uint32_t>(idx.line_of(offset)),
+                       static_cast<std::uint32_t>(resolve_column(offset))};
+        return match{where, length, pattern};
+    }
+
+    std::optional<match> source::find(std::string_view needle, std::size_t from) const
+    {
+        if (needle.empty())
+            throw std::invalid_argument("source: empty search string");
+
+        const char *text = data();
+        std::size_t n = size();
+        if (from >= n)
+            return std::nullopt;
+
+        std::size_t at = from + scan::find(text + from, n - from, needle.data(), needle.size());
+        if (at >= n)
+            return std::nullopt;
+        return resolve(at, needle.size(), 0);
+    }
+
+    std::optional<match> source::find(const pattern_set &patterns, std::size_t from) const
+    {
+        std::size_t length = 0, pattern = 0;
+        std::size_t at = patterns.find(std::string_view(data(), size()), from, length, pattern);
+        if (at == std::string_view::npos)
+            return std::nullopt;
+        return resolve(at, length, pattern);
+    }
+
+    std::vector<match> source::find_all(std::string_view needle) const
+    {
+        std::vector<match> out;
+        for (auto m = find(needle); m; m = find(needle, m->where.offset + m->length))
+            out.push_back(*m);
+        return out;
+    }
+
+    std::vector<match> source::find_all(const pattern_set &patterns) const
+    {
+        std::vector<match> out;
+        for (auto m = find(patterns); m; m = find(patterns, m->where.offset + m->length))
+            out.push_back(*m);
+        return out;
+    }
+
+    bool source::seek_next(std::string_view needle)
+    {
+        auto m = find(needle, position());
+        if (!m)
+            return false;
+        seek(m->where.offset);
+        return true;
+    }
+
+    bool source::seek_next(const pattern_set &patterns)
+    {
+        auto m = find(patterns, position());
+        if (!m)
+            return false;
+        seek(m->where.offset);
+        return true;
+    }
+
+    digest source::content_digest() const
+    {
+        // Fuse with the index build when the index is still to be made over the mapping itself
+        if (!file_.digest_ && !index_ && encoding_ == encoding::utf8)
+        {
+            MMS_STAT(detail::index_build_timer timer);
+            content_hasher hasher;
+            hasher.update(file_.data(), bom_length_);
+            index_ = std::make_unique<line_index>(data_, avail_, tracker_.endings(), &hasher);
+            file_.digest_ = hasher.finish();
+            MMS_STAT(timer.done(index_->lines(), &counters_));
+        }
+        return file_.content_digest();
+    }
+
+    line_range source::lines() const
+    {
+        const line_index &idx = index();
+        return line_range(data_, avail_, idx);
+    }
+
+    line_ending source::endings() const
+    {
+        return tracker_.endings();
+    }
+
+    encoding source::input_encoding() const
+    {
+        return encoding_;
     }
 
     const char *source::data() const
     {
-        return file_.data();
+        decode_all();
+        return data_;
     }
 
     std::size_t source::size() const
     {
-        return file_.size();
+        decode_all();
+        return avail_;
     }
 
-    // Stream-like operator>>
+    const std::string &source::path() const
+    {
+        return file_.path();
+    }
 
-    source &operator>>(source &s, std::string &out)
+    source_stats source::stats() const
+    {
+        source_stats s;
+#if defined(MMS_STATS) && MMS_STATS
+        s = counters_;
+        s.mapped_bytes = file_.size();
+        s.resident_bytes = resident_bytes(file_.data(), file_.size());
+#endif
+        return s;
+    }
+
+    void source::enable_prefetch(const prefetch_options &opts)
     {
-        out.clear();
-        out.reserve(32); // Reasonable default to reduce reallocs
+        if (opts.mode == prefetch_mode::none || file_.size() == 0)
+        {
+            prefetcher_.reset();
+            horizon_ = splicing_ ? 0 : avail_;
+            return;
+        }
 
-        // Skip leading whitespace
-        int ch;
-        while (s && std::isspace(ch = s.peek()))
-            s.get();
+        prefetcher_ = std::make_unique<prefetcher>(file_.data(), file_.size(), opts);
+        cross_horizon(tracker_.position());
+    }
 
-        // Read word
-        while (s && (ch = s.peek()) != EOF && !std::isspace(ch))
-            out += static_cast<char>(s.get());
+    prefetch_stats source::prefetch_statistics() const
+    {
+        return prefetcher_ ? prefetcher_->stats() : prefetch_stats{};
+    }
 
-        return s;
+    void source::enable_change_tracking()
+    {
+        decode_all();
+        head_hashes_ = block_digests(data_, avail_, hash_block);
+        tail_hashes_ = block_digests(data_, avail_, hash_block, true);
+        tracking_ = true;
     }
 
-    source &operator>>(source &s, int &value)
+    bool source::reload()
     {
-        value = 0;
-        bool negative = false;
+        if (file_.path().empty())
+            throw std::logic_error("source: cannot reload a file opened from a descriptor");
+
+        source fresh(file_.path().c_str(), tracker_.endings(), requested_);
+        fresh.decode_all();
+        const char *text = fresh.data_;
+        const std::size_t m = fresh.avail_;
+
+        decode_all();
+        const std::size_t n = avail_;
 
-        // Skip whitespace
-        int ch;
-        while (s && std::isspace(ch = s.peek()))
-            s.get();
+        // Without fingerprints of the old text, all of it counts as replaced
+        text_change c{0, n, m};
+        std::vector<std::uint64_t> head, tail;
+        if (tracking_)
+        {
+            head = block_digests(text, m, hash_block);
+            tail = block_digests(text, m, hash_block, true);
+            std::size_t shorter = std::min(n, m);
+            c.begin = std::min(common_blocks(head_hashes_, head) * hash_block, shorter);
+            std::size_t suffix = std::min(common_blocks(tail_hashes_, tail) * hash_block, shorter - c.begin);
+            c.old_end = n - suffix;
+            c.new_end = m - suffix;
+        }
+        const bool changed = c.begin != c.old_end || c.begin != c.new_end;
 
-        // Optional minus
-        ch = s.peek();
-        if (ch == '-')
+        // The reading position moves with the text
+        std::size_t pos = tracker_.position();
+        if (pos > c.begin)
+            pos = pos >= c.old_end ? pos - c.old_end + c.new_end : c.begin;
+
+        if (index_ && changed)
+            index_->update(text, c.begin, c.old_end, c.new_end);
+
+        // The prefetcher reads the old mapping, so stop it before unmapping
+        std::optional<prefetch_options> prefetch;
+        if (prefetcher_)
+            prefetch = prefetcher_->options();
+        prefetcher_.reset();
+
+        file_ = std::move(fresh.file_);
+        encoding_ = fresh.encoding_;
+        bom_length_ = fresh.bom_length_;
+        data_ = fresh.data_;
+        avail_ = fresh.avail_;
+        decoded_ = std::move(fresh.decoded_);
+        consumed_ = fresh.consumed_;
+
+        column_unit unit = tracker_.columns();
+        std::size_t interval = tracker_.checkpoint_interval();
+        tracker_ = postrack(tracker_.endings());
+        tracker_.set_column_unit(unit, interval);
+        tracker_.attach(data_, avail_);
+        horizon_ = splicing_ ? 0 : avail_;
+        skipped_ = false;
+        splices_.clear();
+        spliced_to_ = 0;
+        if (pos > 0)
         {
-            negative = true;
-            s.get();
+            const line_index &idx = index();
+            tracker_.set_position(bookmark(pos, idx.line_of(pos), resolve_column(pos)));
+            skipped_ = true;
         }
+        if (prefetch)
+            enable_prefetch(*prefetch);
 
-        // Read digits
-        bool read_any = false;
-        while (s && std::isdigit(ch = s.peek()))
+        if (tracking_)
         {
-            read_any = true;
-            value = value * 10 + (s.get() - '0');
+            head_hashes_ = std::move(head);
+            tail_hashes_ = std::move(tail);
         }
+        if (changed)
+            changes_.push_back(c);
+        return changed;
+    }
 
-        if (!read_any)
-            throw std::runtime_error("Invalid integer input");
+    std::uint32_t source::generation() const
+    {
+        return static_cast<std::uint32_t>(changes_.size());
+    }
 
-        if (negative)
-            value = -value;
+    text_change source::last_change() const
+    {
+        return changes_.empty() ? text_change{} : changes_.back();
+    }
 
-        return s;
+    bool source::rebase(bookmark &b) const
+    {
+        if (b.generation() > generation())
+            return false;
+
+        std::size_t pos = b.position();
+        bool moved = false;
+        for (std::size_t g = b.generation(); g < changes_.size(); ++g)
+        {
+            // Text before the change keeps its line and column
+            moved = moved || pos > changes_[g].begin;
+            if (!changes_[g].shift(pos))
+                return false;
+        }
+
+        if (moved)
+        {
+            const line_index &idx = index();
+            b = bookmark(pos, idx.line_of(pos), resolve_column(pos), generation());
+        }
+        else
+        {
+            b = bookmark(pos, b.line(), b.column(), generation());
+        }
+        return true;
+    }
+
+    bool source::cross_horizon(std::size_t pos)
+    {
+        if (pos >= avail_ && !decode_more())
+            return false;
+        std::size_t past = splicing_ ? past_splices(pos) : pos;
+
+        // More text may have been converted since the last crossing (also
+        // by peek or size), so refresh the tracker's view of the buffer.
+        tracker_.attach(data_, avail_);
+        if (past > pos)
+        {
+            // Step over the continuations; the tracker follows the physical lines
+            MMS_STAT(++counters_.splices);
+            for (; pos < past; ++pos)
+                tracker_.update_position(data_[pos]);
+            if (pos >= avail_)
+                return false;
+        }
+        horizon_ = avail_;
+        if (prefetcher_)
+        {
+            // Prefetch in terms of the input; for transcoded text that is
+            // how far conversion has progressed.
+            std::size_t raw = encoding_ == encoding::utf8 ? pos : consumed_;
+            prefetcher_->advance(bom_length_ + raw);
+            horizon_ = std::min(avail_, pos + prefetcher_->options().step);
+        }
+        if (splicing_)
+            horizon_ = std::min({horizon_, next_splice(pos), spliced_to_});
+        return true;
+    }
+
+    void source::set_splicing(bool on)
+    {
+        splicing_ = on;
+        horizon_ = on ? 0 : avail_;
+        if (!on && prefetcher_)
+            cross_horizon(tracker_.position());
+    }
+
+    bool source::splicing() const
+    {
+        return splicing_;
+    }
+
+    void source::find_splices() const
+    {
+        const std::size_t end = avail_;
+        const bool crlf = tracker_.endings() == line_ending::crlf;
+        const char *lf = tracker_.endings() == line_ending::cr ? "\\\r" : "\\\n";
+
+        std::size_t from = spliced_to_;
+        std::size_t removed = 0;
+        if (!splices_.empty())
+        {
+            from = std::max(from, splices_.back().physical);
+            removed = splices_.back().physical - splices_.back().logical;
+        }
+
+        // Both forms are searched for in CRLF text; a bare LF also breaks a line there
+        std::size_t a = from + scan::find(data_ + from, end - from, lf, 2);
+        std::size_t b = crlf ? from + scan::find(data_ + from, end - from, "\\\r\n", 3) : end;
+        while (a < end || b < end)
+        {
+            std::size_t at = std::min(a, b);
+            std::size_t length = at == a ? 2 : 3;
+            removed += length;
+            from = at + length;
+            splices_.push_back(splice{from, from - removed});
+            if (a < from)
+                a = from + scan::find(data_ + from, end - from, lf, 2);
+            if (crlf && b < from)
+                b = from + scan::find(data_ + from, end - from, "\\\r\n", 3);
+        }
+
+        // A continuation may straddle the end of the text converted so far
+        const bool all = consumed_ >= file_.size() - bom_length_;
+        spliced_to_ = all ? end : std::max(from, end - std::min<std::size_t>(end, 2));
+    }
+
+    std::size_t source::past_splices(std::size_t pos) const
+    {
+        for (;;)
+        {
+            while (pos + 3 > avail_ && decode_more())
+            {
+            }
+            if (spliced_to_ < std::min(pos + 3, avail_))
+                find_splices();
+
+            auto it = std::upper_bound(splices_.begin(), splices_.end(), pos,
+                                       [](std::size_t p, const splice &s) { return p < s.physical; });
+            if (it == splices_.end())
+                return pos;
+            std::size_t removed = it->physical - it->logical;
+            std::size_t before = it == splices_.begin() ? 0 : std::prev(it)->physical - std::prev(it)->logical;
+            if (it->physical - (removed - before) > pos)
+                return pos;
+            pos = it->physical;
+        }
+    }
+
+    std::size_t source::next_splice(std::size_t pos) const
+    {
+        auto it = std::upper_bound(splices_.begin(), splices_.end(), pos,
+                                   [](std::size_t p, const splice &s) { return p < s.physical; });
+        if (it == splices_.end())
+            return std::numeric_limits<std::size_t>::max();
+        std::size_t removed = it->physical - it->logical;
+        std::size_t before = it == splices_.begin() ? 0 : std::prev(it)->physical - std::prev(it)->logical;
+        return it->physical - (removed - before);
+    }
+
+    std::size_t source::logical_offset(std::size_t physical) const
+    {
+        decode_all();
+        find_splices();
+        physical = past_splices(std::min(physical, avail_));
+        auto it = std::upper_bound(splices_.begin(), splices_.end(), physical,
+                                   [](std::size_t p, const splice &s) { return p < s.physical; });
+        if (it == splices_.begin())
+            return physical;
+        --it;
+        return physical - (it->physical - it->logical);
+    }
+
+    std::size_t source::physical_offset(std::size_t logical) const
+    {
+        decode_all();
+        find_splices();
+        auto it = std::upper_bound(splices_.begin(), splices_.end(), logical,
+                                   [](std::size_t l, const splice &s) { return l < s.logical; });
+        if (it == splices_.begin())
+            return std::min(logical, avail_);
+        --it;
+        return std::min(logical + (it->physical - it->logical), avail_);
+    }
+
+    location source::physical_location(std::size_t logical) const
+    {
+        std::size_t offset = physical_offset(logical);
+        const line_index &idx = index();
+        return location{offset,
+                        static_cast<std::uint32_t>(idx.line_of(offset)),
+                        static_cast<std::uint32_t>(resolve_column(offset))};
+    }
+
+    bool source::decode_more() const
+    {
+        const std::size_t input = file_.size() - bom_length_;
+        if (consumed_ >= input)
+            return false;
+
+        const char *in = file_.data() + bom_length_;
+        std::size_t before = avail_;
+        do
+        {
+            std::size_t chunk = std::min(decode_chunk, input - consumed_);
+            bool last = consumed_ + chunk == input;
+            std::size_t used = 0;
+            avail_ += transcode_to_utf8(encoding_, in + consumed_, chunk,
+                                        decoded_.get() + avail_, last, used);
+            consumed_ += used;
+
+            // Never stop right after a '\r', so CRLF pairs are seen whole
+        } while (consumed_ < input && (avail_ == before || decoded_[avail_ - 1] == '\r'));
+
+        return avail_ > before;
+    }
+
+    void source::decode_all() const
+    {
+        while (decode_more())
+        {
+        }
+    }
+
+    // Stream-like operator>>
+    //
+    // The extraction logic is shared by every reader type (source, cursor)
+    // that offers the get/peek interface.
+
+    namespace
+    {
+        template <typename Reader>
+        Reader &extract_word(Reader &s, std::string &out)
+        {
+            out.clear();
+            out.reserve(32); // Reasonable default to reduce reallocs
+
+            // Skip leading whitespace
+            int ch;
+            while (s && std::isspace(ch = s.peek()))
+                s.get();
+
+            // Read word
+            while (s && (ch = s.peek()) != EOF && !std::isspace(ch))
+                out += static_cast<char>(s.get());
+
+            return s;
+        }
+
+        template <typename Reader>
+        symbol extract_symbol(Reader &s, intern_pool &pool)
+        {
+            // Skip leading whitespace
+            int ch;
+            while (s && std::isspace(ch = s.peek()))
+                s.get();
+
+            // Collect the word on the stack (the heap only for very long ones), hashing as it goes
+            char buf[256];
+            std::size_t n = 0;
+            std::string longer;
+            std::uint64_t h = intern_pool::hash_seed;
+            while (s && (ch = s.peek()) != EOF && !std::isspace(ch))
+            {
+                char c = static_cast<char>(s.get());
+                h = intern_pool::hash_step(h, c);
+                if (n < sizeof(buf))
+                {
+                    buf[n++] = c;
+                }
+                else
+                {
+                    if (longer.empty())
+                        longer.assign(buf, n);
+                    longer += c;
+                }
+            }
+
+            return pool.intern(longer.empty() ? std::string_view(buf, n) : std::string_view(longer), h);
+        }
+
+        template <typename Reader>
+        result<int> parse_int(Reader &s) noexcept
+        {
+            int value = 0;
+            bool negative = false;
+
+            // Skip whitespace
+            int ch;
+            while (s && std::isspace(ch = s.peek()))
+                s.get();
+
+            // Optional minus
+            ch = s.peek();
+            if (ch == '-')
+            {
+                negative = true;
+                s.get();
+            }
+
+            // Read digits
+            bool read_any = false;
+            while (s && std::isdigit(ch = s.peek()))
+            {
+                read_any = true;
+                value = value * 10 + (s.get() - '0');
+            }
+
+            if (!read_any)
+                return make_error_code(errc::invalid_integer);
+
+            return negative ? -value : value;
+        }
+
+        template <typename Reader>
+        result<char> parse_char(Reader &s) noexcept
+        {
+            // Skip leading whitespace
+            int c;
+            while (s && std::isspace(c = s.peek()))
+                s.get();
+
+            c = s.get();
+            if (c == EOF)
+                return make_error_code(errc::unexpected_eof);
+
+            return static_cast<char>(c);
+        }
+
+        template <typename Reader>
+        Reader &extract_int(Reader &s, int &value)
+        {
+            result<int> r = parse_int(s);
+            if (!r)
+                throw std::runtime_error("Invalid integer input");
+            value = *r;
+            return s;
+        }
+
+        template <typename Reader>
+        Reader &extract_char(Reader &s, char &ch)
+        {
+            result<char> r = parse_char(s);
+            if (!r)
+                throw std::runtime_error("Unexpected EOF while reading char");
+            ch = *r;
+            return s;
+        }
+    } // namespace
+
+    source &operator>>(source &s, std::string &out)
+    {
+        return extract_word(s, out);
+    }
+
+    source &operator>>(source &s, int &value)
+    {
+        return extract_int(s, value);
     }
 
     source &operator>>(source &s, char &ch)
     {
-        // Skip leading whitespace
-        int c;
-        while (s && std::isspace(c = s.peek()))
-            s.get();
+        return extract_char(s, ch);
+    }
+
+    cursor &operator>>(cursor &c, std::string &out)
+    {
+        return extract_word(c, out);
+    }
 
-        c = s.get();
-        if (c == EOF)
-            throw std::runtime_error("Unexpected EOF while reading char");
+    cursor &operator>>(cursor &c, int &value)
+    {
+        return extract_int(c, value);
+    }
 
-        ch = static_cast<char>(c);
-        return s;
+    cursor &operator>>(cursor &c, char &ch)
+    {
+        return extract_char(c, ch);
+    }
+
+    source_stack &operator>>(source_stack &s, std::string &out)
+    {
+        return extract_word(s, out);
+    }
+
+    source_stack &operator>>(source_stack &s, int &value)
+    {
+        return extract_int(s, value);
+    }
+
+    source_stack &operator>>(source_stack &s, char &ch)
+    {
+        return extract_char(s, ch);
+    }
+
+    overlay &operator>>(overlay &o, std::string &out)
+    {
+        return extract_word(o, out);
+    }
+
+    overlay &operator>>(overlay &o, int &value)
+    {
+        return extract_int(o, value);
+    }
+
+    overlay &operator>>(overlay &o, char &ch)
+    {
+        return extract_char(o, ch);
+    }
+
+    result<int> read_int(source &s) noexcept
+    {
+        return parse_int(s);
+    }
+
+    result<char> read_char(source &s) noexcept
+    {
+        return parse_char(s);
+    }
+
+    result<int> read_int(cursor &c) noexcept
+    {
+        return parse_int(c);
+    }
+
+    result<char> read_char(cursor &c) noexcept
+    {
+        return parse_char(c);
+    }
+
+    result<int> read_int(source_stack &s) noexcept
+    {
+        return parse_int(s);
+    }
+
+    result<char> read_char(source_stack &s) noexcept
+    {
+        return parse_char(s);
+    }
+
+    result<int> read_int(overlay &o) noexcept
+    {
+        return parse_int(o);
+    }
+
+    result<char> read_char(overlay &o) noexcept
+    {
+        return parse_char(o);
+    }
+
+    symbol read_symbol(source &s, intern_pool &pool)
+    {
+        return extract_symbol(s, pool);
+    }
+
+    symbol read_symbol(cursor &c, intern_pool &pool)
+    {
+        return extract_symbol(c, pool);
+    }
+
+    symbol read_symbol(source_stack &s, intern_pool &pool)
+    {
+        return extract_symbol(s, pool);
+    }
+
+    symbol read_symbol(overlay &o, intern_pool &pool)
+    {
+        return extract_symbol(o, pool);
     }
 
 } // namespace mms
@@ -0,0 +1,191 @@
+/// \file
+/// \brief Implementation of the `mms::source_stack` class.
+///
+/// The stack keeps every file it opened in a frame table and the files
+/// currently being read as a chain of frame ids. Reading is forwarded to
+/// the innermost source; the chain is only walked when that source is
+/// exhausted, so nesting costs nothing per character.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <limits>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    namespace
+    {
+        constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+    }
+
+    source_stack::source_stack(const char *filename, line_ending endings, encoding enc)
+        : top_(nullptr), popped_(none), popped_at_(0)
+    {
+        push(filename, endings, enc);
+    }
+
+    source_stack::~source_stack() = default;
+
+    void source_stack::push(const char *filename, line_ending endings, encoding enc)
+    {
+        auto src = std::make_unique<source>(filename, endings, enc);
+        top_ = src.get();
+        frames_.push_back(frame{std::move(src), filename});
+        chain_.push_back(frames_.size() - 1);
+        popped_ = none;
+    }
+
+    void source_stack::pop()
+    {
+        if (chain_.size() < 2)
+            throw std::logic_error("source_stack: cannot pop the outermost file");
+        chain_.pop_back();
+        top_ = frames_[chain_.back()].src.get();
+        popped_ = none;
+    }
+
+    std::size_t source_stack::depth() const
+    {
+        return chain_.size();
+    }
+
+    source &source_stack::top()
+    {
+        return *top_;
+    }
+
+    const source &source_stack::top() const
+    {
+        return *top_;
+    }
+
+    const std::string &source_stack::file_name() const
+    {
+        return frames_[chain_.back()].path;
+    }
+
+    std::vector<include_frame> source_stack::include_chain() const
+    {
+        std::vector<include_frame> chain;
+        chain.reserve(chain_.size());
+        for (std::size_t id : chain_)
+        {
+            const frame &f = frames_[id];
+            chain.push_back(include_frame{f.path, f.src->line(), f.src->column()});
+        }
+        return chain;
+    }
+
+    int source_stack::get()
+    {
+        int ch = top_->get();
+        if (ch != EOF || !underflow())
+            return ch;
+        return top_->get();
+    }
+
+    bool source_stack::underflow()
+    {
+        if (chain_.size() < 2)
+            return false;
+
+        // Pop every exhausted file; remember the last one for putback
+        while (chain_.size() > 1 && !*top_)
+        {
+            popped_ = chain_.back();
+            chain_.pop_back();
+            top_ = frames_[chain_.back()].src.get();
+        }
+        popped_at_ = top_->position();
+        return static_cast<bool>(*top_);
+    }
+
+    int source_stack::peek() const
+    {
+        for (auto it = chain_.rbegin(); it != chain_.rend(); ++it)
+        {
+            int ch = frames_[*it].src->peek();
+            if (ch != EOF)
+                return ch;
+        }
+        return EOF;
+    }
+
+    void source_stack::putback()
+    {
+        // Right after an automatic pop the last character read belongs to
+        // the popped file: put it back on the stack and step back there.
+        if (popped_ != none && top_->position() == popped_at_)
+        {
+            chain_.push_back(popped_);
+            top_ = frames_[popped_].src.get();
+            popped_ = none;
+        }
+        top_->putback();
+    }
+
+    source_stack::operator bool() const
+    {
+        for (auto it = chain_.rbegin(); it != chain_.rend(); ++it)
+            if (*frames_[*it].src)
+                return true;
+        return false;
+    }
+
+    std::size_t source_stack::position() const
+    {
+        return top_->position();
+    }
+
+    int source_stack::line() const
+    {
+        return top_->line();
+    }
+
+    int source_stack::column() const
+    {
+        return top_->column();
+    }
+
+    stack_bookmark source_stack::mark() const
+    {
+        stack_bookmark b;
+        b.frames.reserve(chain_.size());
+        for (std::size_t id : chain_)
+            b.frames.emplace_back(id, frames_[id].src->mark());
+        return b;
+    }
+
+    void source_stack::seek(const stack_bookmark &b)
+    {
+        if (b.frames.empty())
+            throw std::invalid_argument("source_stack: empty bookmark");
+        for (const auto &[id, mark] : b.frames)
+            if (id >= frames_.size() || !frames_[id].src)
+                throw std::invalid_argument("source_stack: bookmark refers to a released file");
+
+        chain_.clear();
+        for (const auto &[id, mark] : b.frames)
+        {
+            frames_[id].src->seek(mark);
+            chain_.push_back(id);
+        }
+        top_ = frames_[chain_.back()].src.get();
+        popped_ = none;
+    }
+
+    void source_stack::release_inactive()
+    {
+        std::vector<bool> active(frames_.size(), false);
+        for (std::size_t id : chain_)
+            active[id] = true;
+        for (std::size_t id = 0; id < frames_.size(); ++id)
+            if (!active[id])
+                frames_[id].src.reset();
+        popped_ = none;
+    }
+
+} // namespace mms
@@ -0,0 +1,148 @@
+/// \file
+/// \brief Instrumentation counters: aggregation, residency and fault sampling.
+///
+/// Per-source counters are compiled in only when the library is built with
+/// `MMS_ENABLE_STATS`. This file holds the process-wide aggregate that
+/// sources report into, plus the `mincore` and `getrusage` sampling used by
+/// the snapshots.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <unistd.h>         // sysconf
+#include <sys/mman.h>       // mincore
+#include <sys/resource.h>   // getrusage
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    namespace
+    {
+        struct registry
+        {
+            std::mutex mutex;
+            source_stats totals;
+            std::map<const void *, std::size_t> live;
+        };
+
+        registry &global_registry()
+        {
+            static registry r;
+            return r;
+        }
+    } // namespace
+
+    source_stats &source_stats::operator+=(const source_stats &other)
+    {
+        gets += other.gets;
+        peeks += other.peeks;
+        putbacks += other.putbacks;
+        seeks_bookmark += other.seeks_bookmark;
+        seeks_index += other.seeks_index;
+        seeks_rescan += other.seeks_rescan;
+        splices += other.splices;
+        index_builds += other.index_builds;
+        index_build_ns += other.index_build_ns;
+        index_lines += other.index_lines;
+        mapped_bytes += other.mapped_bytes;
+        resident_bytes += other.resident_bytes;
+        major_faults += other.major_faults;
+        minor_faults += other.minor_faults;
+        return *this;
+    }
+
+    source_stats global_stats()
+    {
+        source_stats s;
+        if constexpr (!stats_enabled)
+            return s;
+
+        registry &r = global_registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            s = r.totals;
+            for (const auto &[addr, size] : r.live)
+            {
+                s.mapped_bytes += size;
+                s.resident_bytes += resident_bytes(addr, size);
+            }
+        }
+
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            s.major_faults = static_cast<std::uint64_t>(usage.ru_majflt);
+            s.minor_faults = static_cast<std::uint64_t>(usage.ru_minflt);
+        }
+        return s;
+    }
+
+    std::size_t resident_bytes(const void *addr, std::size_t size)
+    {
+        if (!addr || size == 0)
+            return 0;
+
+        std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        auto start = reinterpret_cast<std::uintptr_t>(addr) / page * page;
+        auto end = reinterpret_cast<std::uintptr_t>(addr) + size;
+        std::size_t pages = (end - start + page - 1) / page;
+
+        std::vector<unsigned char> vec(pages);
+        if (mincore(reinterpret_cast<void *>(start), end - start, vec.data()) != 0)
+            return 0;
+
+        std::size_t resident = 0;
+        for (std::size_t i = 0; i < pages; ++i)
+            if (vec[i] & 1)
+                resident += page;
+
+        // The first and last pages may extend beyond the range
+        return resident < size ? resident : size;
+    }
+
+    namespace detail
+    {
+        void accumulate_stats(const source_stats &s)
+        {
+            registry &r = global_registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.totals += s;
+        }
+
+        index_build_timer::index_build_timer()
+            : started_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count()) {}
+
+        void index_build_timer::done(std::size_t lines, source_stats *local) const
+        {
+            source_stats s;
+            s.index_builds = 1;
+            s.index_build_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count() -
+                               started_ns_;
+            s.index_lines = lines;
+            accumulate_stats(s);
+            if (local)
+                *local += s;
+        }
+
+        void track_mapping(const void *addr, std::size_t size, bool add)
+        {
+            registry &r = global_registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (add)
+                r.live[addr] = size;
+            else
+                r.live.erase(addr);
+        }
+    } // namespace detail
+
+} // namespace mms
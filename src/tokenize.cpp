@@ -0,0 +1,147 @@
+/// \file
+/// \brief Support code for the coroutine tokenizer and the batched token pipeline.
+///
+/// `advance_location` moves a compact location over a consumed byte range,
+/// and `token_pipeline` implements the bounded hand-over of token batches
+/// from a producer thread to a consumer.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <cstring>
+#include <utility>
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    location advance_location(location loc, std::string_view consumed, line_ending endings)
+    {
+        const char brk = endings == line_ending::cr ? '\r' : '\n';
+        const char *p = consumed.data();
+        const char *end = p + consumed.size();
+        const char *line_start = nullptr;
+
+        while (p < end)
+        {
+            const void *hit = std::memchr(p, brk, end - p);
+            if (!hit)
+                break;
+            p = static_cast<const char *>(hit) + 1;
+            ++loc.line;
+            line_start = p;
+        }
+
+        if (line_start)
+            loc.column = static_cast<std::uint32_t>(end - line_start) + 1;
+        else
+            loc.column += static_cast<std::uint32_t>(consumed.size());
+
+        // The '\r' of a CRLF pair takes no column; one ending the range is
+        // assumed to be followed by its '\n'
+        if (endings == line_ending::crlf && !consumed.empty() && consumed.back() == '\r')
+            --loc.column;
+
+        loc.offset += consumed.size();
+        return loc;
+    }
+
+    token_pipeline::~token_pipeline()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        space_.notify_all();
+        ready_.notify_all();
+        if (worker_.joinable())
+            worker_.join();
+    }
+
+    void token_pipeline::prepare()
+    {
+        // One batch is always owned by the producer and one by the consumer;
+        // the remaining ones circulate through the queues.
+        free_.resize(depth_);
+        for (auto &b : free_)
+            b.reserve(batch_size_);
+    }
+
+    bool token_pipeline::acquire(std::vector<token> &batch)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [this]
+                    { return stopping_ || !free_.empty(); });
+        if (stopping_)
+            return false;
+
+        batch = std::move(free_.back());
+        free_.pop_back();
+        batch.clear();
+        return true;
+    }
+
+    bool token_pipeline::publish(std::vector<token> &batch)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopping_)
+                return false;
+            full_.push_back(std::move(batch));
+        }
+        ready_.notify_one();
+
+        return acquire(batch);
+    }
+
+    void token_pipeline::finish(std::vector<token> &last, std::exception_ptr error)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!last.empty() && !stopping_)
+            {
+                try
+                {
+                    full_.push_back(std::move(last));
+                }
+                catch (...)
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+            error_ = std::move(error);
+            done_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    bool token_pipeline::next(std::vector<token> &batch)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // Hand the previous batch back to the producer for reuse
+        if (batch.capacity() > 0)
+        {
+            batch.clear();
+            free_.push_back(std::move(batch));
+            batch = {};
+            space_.notify_one();
+        }
+
+        ready_.wait(lock, [this]
+                    { return done_ || stopping_ || !full_.empty(); });
+        if (full_.empty())
+        {
+            if (error_)
+                std::rethrow_exception(std::exchange(error_, nullptr));
+            return false;
+        }
+
+        batch = std::move(full_.front());
+        full_.pop_front();
+        return true;
+    }
+
+} // namespace mms
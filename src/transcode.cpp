@@ -0,0 +1,219 @@
+/// \file
+/// \brief Byte order mark detection and conversion of UTF-16/Latin-1 to UTF-8.
+///
+/// `source` presents every input as UTF-8. UTF-8 files are read in place;
+/// other encodings are converted block by block with the routines below.
+/// Runs of ASCII, by far the common case in source code, are converted
+/// 16 bytes at a time with SSE2.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <mms/mms.h>
+
+namespace mms
+{
+
+    namespace
+    {
+        constexpr std::uint32_t replacement_char = 0xFFFD;
+
+        inline char *put_utf8(char *out, std::uint32_t cp)
+        {
+            if (cp < 0x80)
+            {
+                *out++ = static_cast<char>(cp);
+            }
+            else if (cp < 0x800)
+            {
+                *out++ = static_cast<char>(0xC0 | (cp >> 6));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000)
+            {
+                *out++ = static_cast<char>(0xE0 | (cp >> 12));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else
+            {
+                *out++ = static_cast<char>(0xF0 | (cp >> 18));
+                *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            return out;
+        }
+
+        std::size_t latin1_to_utf8(const char *in, std::size_t size, char *out, std::size_t &consumed)
+        {
+            char *start = out;
+            std::size_t i = 0;
+            while (i < size)
+            {
+#if defined(__SSE2__)
+                // Copy whole blocks of ASCII unchanged
+                while (i + 16 <= size)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                    if (_mm_movemask_epi8(v) != 0)
+                        break;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), v);
+                    i += 16;
+                    out += 16;
+                }
+                if (i >= size)
+                    break;
+#endif
+                out = put_utf8(out, static_cast<unsigned char>(in[i++]));
+            }
+            consumed = size;
+            return out - start;
+        }
+
+        template <bool BigEndian>
+        std::size_t utf16_to_utf8(const char *in, std::size_t size, char *out, bool last, std::size_t &consumed)
+        {
+            auto unit_at = [in](std::size_t i) -> std::uint32_t
+            {
+                auto lo = static_cast<unsigned char>(in[i + (BigEndian ? 1 : 0)]);
+                auto hi = static_cast<unsigned char>(in[i + (BigEndian ? 0 : 1)]);
+                return static_cast<std::uint32_t>(hi) << 8 | lo;
+            };
+
+            char *start = out;
+            std::size_t i = 0;
+            while (i + 2 <= size)
+            {
+#if defined(__SSE2__)
+                // 16 ASCII code units become 16 output bytes
+                const __m128i high_mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+                const __m128i zero = _mm_setzero_si128();
+                while (i + 32 <= size)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 16));
+                    if constexpr (BigEndian)
+                    {
+                        a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+                        b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+                    }
+                    __m128i non_ascii = _mm_or_si128(_mm_and_si128(a, high_mask), _mm_and_si128(b, high_mask));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(non_ascii, zero)) != 0xFFFF)
+                        break;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(a, b));
+                    i += 32;
+                    out += 16;
+                }
+                if (i + 2 > size)
+                    break;
+#endif
+                std::uint32_t u = unit_at(i);
+                if (u >= 0xD800 && u <= 0xDBFF)
+                {
+                    if (i + 4 <= size)
+                    {
+                        std::uint32_t low = unit_at(i + 2);
+                        if (low >= 0xDC00 && low <= 0xDFFF)
+                        {
+                            out = put_utf8(out, 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00));
+                            i += 4;
+                            continue;
+                        }
+                    }
+                    else if (!last)
+                    {
+                        break; // The pair continues in the next block
+                    }
+                    out = put_utf8(out, replacement_char);
+                    i += 2;
+                }
+                else if (u >= 0xDC00 && u <= 0xDFFF)
+                {
+                    out = put_utf8(out, replacement_char);
+                    i += 2;
+                }
+                else
+                {
+                    out = put_utf8(out, u);
+                    i += 2;
+                }
+            }
+
+            // A dangling odd byte at the very end
+            if (last && i < size && i + 2 > size)
+            {
+                out = put_utf8(out, replacement_char);
+                i = size;
+            }
+
+            consumed = i;
+            return out - start;
+        }
+    } // namespace
+
+    encoding detect_encoding(const char *data, std::size_t size, std::size_t &bom_length)
+    {
+        auto byte = [data](std::size_t i)
+        { return static_cast<unsigned char>(data[i]); };
+
+        if (size >= 3 && byte(0) == 0xEF && byte(1) == 0xBB && byte(2) == 0xBF)
+        {
+            bom_length = 3;
+            return encoding::utf8;
+        }
+        if (size >= 2 && byte(0) == 0xFF && byte(1) == 0xFE)
+        {
+            bom_length = 2;
+            return encoding::utf16le;
+        }
+        if (size >= 2 && byte(0) == 0xFE && byte(1) == 0xFF)
+        {
+            bom_length = 2;
+            return encoding::utf16be;
+        }
+
+        bom_length = 0;
+        return encoding::utf8;
+    }
+
+    std::size_t utf8_capacity(encoding enc, std::size_t size)
+    {
+        switch (enc)
+        {
+        case encoding::utf16le:
+        case encoding::utf16be:
+            // At most 3 bytes per code unit, plus a replacement for an odd byte
+            return size / 2 * 3 + 3;
+        case encoding::latin1:
+            return size * 2;
+        default:
+            return size;
+        }
+    }
+
+    std::size_t transcode_to_utf8(encoding enc, const char *in, std::size_t size,
+                                  char *out, bool last, std::size_t &consumed)
+    {
+        switch (enc)
+        {
+        case encoding::utf16le:
+            return utf16_to_utf8<false>(in, size, out, last, consumed);
+        case encoding::utf16be:
+            return utf16_to_utf8<true>(in, size, out, last, consumed);
+        case encoding::latin1:
+            return latin1_to_utf8(in, size, out, consumed);
+        default:
+            std::memcpy(out, in, size);
+            consumed = size;
+            return size;
+        }
+    }
+
+} // namespace mms
@@ -0,0 +1,145 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+using mms::batch_opener;
+using mms::batch_options;
+
+extern fs::path exeDir;
+
+// Fixture: writes small files "batch_<i>.txt" containing "file <i>" and removes them afterwards
+class BatchOpener : public ::testing::Test
+{
+protected:
+    std::vector<std::string> write_files(std::size_t n)
+    {
+        std::vector<std::string> paths;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto path = exeDir / "data" / ("batch_" + std::to_string(i) + ".txt");
+            std::ofstream out(path, std::ios::binary);
+            out << "file " << i;
+            paths.push_back(path.string());
+        }
+        written_.insert(written_.end(), paths.begin(), paths.end());
+        return paths;
+    }
+
+    void TearDown() override
+    {
+        for (const auto &path : written_)
+            fs::remove(path);
+    }
+
+private:
+    std::vector<std::string> written_;
+};
+
+// Helper: drain the opener, checking each source against its path
+static void check_all(batch_opener &opener, std::size_t expected)
+{
+    std::set<std::size_t> seen;
+    while (auto r = opener.next())
+    {
+        ASSERT_TRUE(r->src) << "index " << r->index;
+        std::string word;
+        int value;
+        *r->src >> word >> value;
+        EXPECT_EQ(word, "file");
+        EXPECT_EQ(static_cast<std::size_t>(value), r->index);
+        EXPECT_TRUE(seen.insert(r->index).second);
+    }
+    EXPECT_EQ(seen.size(), expected);
+}
+
+TEST_F(BatchOpener, OpensEveryFileOnce)
+{
+    auto paths = write_files(300);
+    batch_options opts;
+    opts.queue_depth = 16;
+    batch_opener opener(paths, opts);
+    EXPECT_EQ(opener.size(), 300u);
+    check_all(opener, 300);
+    EXPECT_FALSE(opener.next());
+}
+
+TEST_F(BatchOpener, ThreadPoolFallback)
+{
+    auto paths = write_files(100);
+    batch_options opts;
+    opts.use_io_uring = false;
+    opts.threads = 4;
+    batch_opener opener(paths, opts);
+    EXPECT_FALSE(opener.uses_io_uring());
+    check_all(opener, 100);
+}
+
+TEST_F(BatchOpener, ThreadPoolFallbackHonorsQueueDepth)
+{
+    auto count_fds = []
+    {
+        auto it = fs::directory_iterator("/proc/self/fd");
+        return static_cast<std::size_t>(std::distance(fs::begin(it), fs::end(it)));
+    };
+
+    auto paths = write_files(100);
+    std::size_t before = count_fds();
+    batch_options opts;
+    opts.use_io_uring = false;
+    opts.threads = 4;
+    opts.queue_depth = 4;
+    batch_opener opener(paths, opts);
+    auto first = opener.next();
+    ASSERT_TRUE(first && first->src);
+
+    // Give the workers time to run ahead if they were unbounded
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_LE(count_fds(), before + 1 + opts.queue_depth);
+    check_all(opener, 99);
+}
+
+TEST_F(BatchOpener, ReportsMissingFilesAsErrors)
+{
+    auto paths = write_files(3);
+    paths.insert(paths.begin() + 1, (exeDir / "data" / "batch_missing.txt").string());
+    for (bool uring : {true, false})
+    {
+        batch_options opts;
+        opts.use_io_uring = uring;
+        batch_opener opener(paths, opts);
+        std::size_t errors = 0, opened = 0;
+        while (auto r = opener.next())
+        {
+            if (r->index == 1)
+            {
+                EXPECT_FALSE(r->src);
+                EXPECT_THROW(std::rethrow_exception(r->error), std::ios_base::failure);
+                ++errors;
+            }
+            else
+            {
+                EXPECT_TRUE(r->src);
+                ++opened;
+            }
+        }
+        EXPECT_EQ(errors, 1u);
+        EXPECT_EQ(opened, 3u);
+    }
+}
+
+TEST_F(BatchOpener, DestroyedBeforeDrained)
+{
+    auto paths = write_files(50);
+    batch_opener opener(paths);
+    auto first = opener.next();
+    EXPECT_TRUE(first && first->src);
+}
@@ -0,0 +1,127 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::binary_reader;
+
+TEST(BinaryReader, ReadsIntegersInEitherByteOrder)
+{
+    const std::string bytes("\x7F" "ELF\x01\x02\x03\x04\x05\x06\x07\x08", 12);
+    binary_reader r(bytes.data(), bytes.size());
+
+    EXPECT_EQ(r.read_be<std::uint32_t>(), 0x7F454C46u);
+    EXPECT_EQ(r.read_le<std::uint16_t>(), 0x0201u);
+    EXPECT_EQ(r.read_be<std::uint16_t>(), 0x0304u);
+    EXPECT_EQ(r.position(), 8u);
+    EXPECT_EQ(r.read_int<std::int32_t>(), 0x08070605);
+
+    r.seek(4);
+    r.set_order(std::endian::big);
+    EXPECT_EQ(r.read_int<std::uint64_t>(), 0x0102030405060708u);
+    EXPECT_EQ(r.remaining(), 0u);
+}
+
+TEST(BinaryReader, ChecksBounds)
+{
+    const char bytes[] = {1, 2, 3};
+    binary_reader r(bytes, 3);
+    EXPECT_THROW(r.read<std::uint32_t>(), std::out_of_range);
+    EXPECT_EQ(r.position(), 0u); // a failed read does not move
+    r.skip(2);
+    EXPECT_THROW(r.skip(2), std::out_of_range);
+    EXPECT_THROW(r.seek(4), std::out_of_range);
+    EXPECT_THROW(r.sub(2, 2), std::out_of_range);
+    EXPECT_THROW(r.read_bytes(SIZE_MAX), std::out_of_range);
+    EXPECT_EQ(r.read<std::uint8_t>(), 3);
+}
+
+TEST(BinaryReader, DecodesLeb128)
+{
+    // 624485 unsigned, -123456 signed, 2^64 - 1, INT64_MIN, then a truncated number
+    const std::string bytes("\xE5\x8E\x26" "\xC0\xBB\x78"
+                            "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01"
+                            "\x80\x80\x80\x80\x80\x80\x80\x80\x80\x7F"
+                            "\x80",
+                            27);
+    binary_reader r(bytes.data(), bytes.size());
+    EXPECT_EQ(r.read_uleb128(), 624485u);
+    EXPECT_EQ(r.read_sleb128(), -123456);
+    EXPECT_EQ(r.read_uleb128(), UINT64_MAX);
+    EXPECT_EQ(r.read_sleb128(), INT64_MIN);
+    EXPECT_THROW(r.read_uleb128(), std::out_of_range);
+
+    const std::string overflow("\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x02", 10);
+    binary_reader o(overflow.data(), overflow.size());
+    EXPECT_THROW(o.read_uleb128(), std::invalid_argument);
+}
+
+TEST(BinaryReader, ReadsStringsAndSubRegions)
+{
+    const std::string bytes(".text\0.data\0", 12);
+    binary_reader r(bytes.data(), bytes.size());
+    auto strtab = r.sub(6, 6);
+    EXPECT_EQ(strtab.read_string(), ".data");
+    EXPECT_EQ(strtab.remaining(), 0u);
+    EXPECT_EQ(r.read_string(), ".text");
+
+    binary_reader unterminated(bytes.data(), 5);
+    EXPECT_THROW(unterminated.read_string(), std::out_of_range);
+}
+
+TEST(BinaryReader, ViewsAlignedTablesInPlace)
+{
+    std::string content(8, '\0');
+    for (std::uint32_t i = 0; i < 100; ++i)
+        content.append(reinterpret_cast<const char *>(&i), sizeof i);
+    auto path = write_file("binary-table.bin", content);
+    mms::file f(path.c_str());
+    binary_reader r(f);
+
+    r.seek(8);
+    auto table = r.view<std::uint32_t>(100);
+    EXPECT_EQ(table.data(), reinterpret_cast<const std::uint32_t *>(f.data() + 8));
+    EXPECT_EQ(table[99], 99u);
+
+    r.seek(9);
+    EXPECT_THROW(r.view<std::uint32_t>(1), std::invalid_argument);
+    EXPECT_THROW(r.view<std::uint32_t>(1000), std::out_of_range);
+}
+
+TEST(BinaryReader, ConvertsTablesOfEveryWidth)
+{
+    std::string bytes;
+    for (int i = 0; i < 203; ++i)
+        bytes += static_cast<char>(i * 7);
+    auto expect_swapped = [&](auto sample) {
+        using T = decltype(sample);
+        std::size_t count = bytes.size() / sizeof(T);
+        binary_reader foreign(bytes.data(), bytes.size(),
+                              std::endian::native == std::endian::little ? std::endian::big : std::endian::little);
+        binary_reader one(bytes.data(), bytes.size(), foreign.order());
+
+        std::vector<T> table(count);
+        foreign.read_ints(std::span<T>(table));
+        EXPECT_EQ(foreign.position(), count * sizeof(T));
+        for (std::size_t i = 0; i < count; ++i)
+            ASSERT_EQ(table[i], one.read_int<T>()) << sizeof(T) << " " << i;
+    };
+    expect_swapped(std::uint8_t{});
+    expect_swapped(std::int16_t{});
+    expect_swapped(std::uint32_t{});
+    expect_swapped(std::int64_t{});
+
+    binary_reader native(bytes.data(), bytes.size(), std::endian::native);
+    std::vector<std::uint32_t> table(50);
+    native.read_ints(std::span<std::uint32_t>(table));
+    EXPECT_EQ(std::memcmp(table.data(), bytes.data(), 200), 0);
+}
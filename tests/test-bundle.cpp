@@ -0,0 +1,79 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::bundle;
+using mms::bundle_builder;
+
+TEST(Bundle, MembersReadLikeTheirFiles)
+{
+    bundle_builder b;
+    b.add("include/b.h", write_file("bundle-b.h", "#pragma once\nint b;\n").string());
+    b.add("include/a.h", write_file("bundle-a.h", "int a;\r\nint aa;\r\n").string());
+    b.add("empty.h", write_file("bundle-empty.h", "").string());
+    EXPECT_EQ(b.size(), 3u);
+    auto path = exeDir / "data" / "headers.bundle";
+    b.write(path.c_str());
+
+    bundle headers(path.c_str());
+    ASSERT_EQ(headers.size(), 3u);
+    EXPECT_EQ(headers.path(0), "empty.h"); // sorted by path
+    EXPECT_EQ(headers.find("include/b.h"), 2u);
+    EXPECT_FALSE(headers.find("include/c.h"));
+    EXPECT_EQ(headers.contents(1), "int a;\r\nint aa;\r\n");
+
+    auto a = headers.open("include/a.h");
+    EXPECT_EQ(a->path(), "include/a.h");
+    EXPECT_EQ(a->endings(), mms::line_ending::crlf);
+    std::string w;
+    *a >> w >> w >> w;
+    EXPECT_EQ(w, "int");
+    EXPECT_EQ(a->line(), 2); // numbered from the member's own start
+    EXPECT_EQ(a->column(), 4);
+    EXPECT_EQ(a->index().lines(), 3u);
+    EXPECT_EQ(a->index().column_of(6), 7); // the stored index knows the CRLF pairs
+
+    auto empty = headers.open(std::size_t{0});
+    EXPECT_EQ(empty->get(), EOF);
+    EXPECT_THROW(headers.open("missing.h"), std::ios_base::failure);
+}
+
+TEST(Bundle, MembersOutliveTheBundle)
+{
+    bundle_builder b;
+    b.add("x", write_file("bundle-x.txt", "one two\nthree").string());
+    auto path = exeDir / "data" / "outlive.bundle";
+    b.write(path.c_str());
+
+    std::unique_ptr<mms::source> x;
+    {
+        bundle single(path.c_str());
+        x = single.open("x");
+    }
+    x->seek(std::size_t{8});
+    std::string w;
+    *x >> w;
+    EXPECT_EQ(w, "three");
+    EXPECT_EQ(x->line(), 2);
+    EXPECT_EQ(x->content_digest(), mms::content_hasher::hash("one two\nthree", 13));
+}
+
+TEST(Bundle, RejectsOtherFilesAndDuplicates)
+{
+    auto other = write_file("not-a.bundle", "just some text that is long enough");
+    EXPECT_THROW(bundle(other.c_str()), std::ios_base::failure);
+
+    bundle_builder b;
+    auto f = write_file("bundle-dup.txt", "x").string();
+    b.add("same", f);
+    b.add("same", f);
+    auto path = exeDir / "data" / "dup.bundle";
+    EXPECT_THROW(b.write(path.c_str()), std::invalid_argument);
+}
@@ -0,0 +1,119 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::content_hasher;
+using mms::digest;
+
+static std::string random_text(std::size_t size, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::string s(size, '\0');
+    for (char &c : s)
+        c = static_cast<char>(rng());
+    return s;
+}
+
+TEST(ContentHasher, StreamingMatchesOneShot)
+{
+    std::string text = random_text(5000, 1);
+    std::mt19937 rng(2);
+    for (std::size_t size : {0u, 1u, 63u, 64u, 65u, 1023u, 1024u, 1025u, 5000u})
+    {
+        digest expected = content_hasher::hash(text.data(), size);
+        content_hasher h;
+        std::size_t done = 0;
+        while (done < size)
+        {
+            std::size_t n = std::min<std::size_t>(rng() % 150, size - done);
+            h.update(text.data() + done, n);
+            done += n;
+        }
+        EXPECT_EQ(h.finish(), expected) << size;
+    }
+}
+
+TEST(ContentHasher, DistinguishesSimilarInputs)
+{
+    std::string text = random_text(4096, 3);
+    std::set<std::pair<std::uint64_t, std::uint64_t>> seen;
+    auto add = [&](const std::string &s)
+    {
+        digest d = content_hasher::hash(s.data(), s.size());
+        return seen.insert({d.low, d.high}).second;
+    };
+
+    EXPECT_TRUE(add(text));
+    for (std::size_t bit = 0; bit < text.size() * 8; bit += 13)
+    {
+        std::string flipped = text;
+        flipped[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+        EXPECT_TRUE(add(flipped)) << bit;
+    }
+
+    // Reordered stripes and blocks, and zero padding
+    std::string stripes = text.substr(64, 64) + text.substr(0, 64) + text.substr(128);
+    std::string blocks = text.substr(1024, 1024) + text.substr(0, 1024) + text.substr(2048);
+    EXPECT_TRUE(add(stripes));
+    EXPECT_TRUE(add(blocks));
+    EXPECT_TRUE(add(std::string("a")));
+    EXPECT_TRUE(add(std::string("a\0", 2)));
+    EXPECT_TRUE(add(std::string()));
+    EXPECT_EQ(content_hasher::hash("a", 1).hex().size(), 32u);
+}
+
+TEST(ContentHasher, FileAndSourceDigestsAgree)
+{
+    std::string text;
+    for (int i = 0; i < 20000; ++i)
+        text += "line " + std::to_string(i) + "\r\n";
+    auto path = write_file("digest.txt", text);
+    digest expected = content_hasher::hash(text.data(), text.size());
+
+    mms::file f(path.c_str());
+    EXPECT_EQ(f.content_digest(), expected);
+    EXPECT_EQ(f.content_digest(), expected); // cached
+
+    // Fused with the index build
+    mms::source s(path.c_str());
+    EXPECT_EQ(s.content_digest(), expected);
+    EXPECT_EQ(s.index().lines(), 20001u);
+    EXPECT_EQ(s.index().endings(), mms::line_ending::crlf);
+    mms::line_index reference(text.data(), text.size(), mms::line_ending::crlf);
+    EXPECT_EQ(s.index().newline_positions(), reference.newline_positions());
+
+    // The digest covers the byte order mark too
+    auto bom = write_file("digest-bom.txt", "\xEF\xBB\xBFtext\n");
+    mms::source b(bom.c_str());
+    EXPECT_EQ(b.content_digest(), content_hasher::hash("\xEF\xBB\xBFtext\n", 8));
+}
+
+TEST(ContentHasher, BlockDigestsLocateChanges)
+{
+    std::string text = random_text(10000, 4);
+    auto before = mms::block_digests(text.data(), text.size());
+    text[5000] ^= 1;
+    auto after = mms::block_digests(text.data(), text.size());
+
+    ASSERT_EQ(before.size(), 3u);
+    ASSERT_EQ(after.size(), 3u);
+    EXPECT_EQ(before[0], after[0]);
+    EXPECT_NE(before[1], after[1]);
+    EXPECT_EQ(before[2], after[2]);
+    EXPECT_THROW(mms::block_digests(text.data(), text.size(), 0), std::invalid_argument);
+
+    // Aligned to the end, the list starts with the last block
+    auto tail = mms::block_digests(text.data(), text.size(), 4096, true);
+    ASSERT_EQ(tail.size(), 3u);
+    EXPECT_EQ(tail[0], content_hasher::hash(text.data() + 10000 - 4096, 4096).low);
+    EXPECT_EQ(tail[2], content_hasher::hash(text.data(), 10000 - 2 * 4096).low);
+}
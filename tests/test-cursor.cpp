@@ -0,0 +1,115 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::bookmark;
+using mms::cursor;
+using mms::mapped_source;
+
+TEST(Cursor, ReadsAndTracksPosition)
+{
+    auto path = write_file("cursor.txt", "ab\ncd");
+    mapped_source ms(path.c_str());
+    cursor c(ms);
+
+    EXPECT_EQ(c.get(), 'a');
+    EXPECT_EQ(c.get(), 'b');
+    EXPECT_EQ(c.get(), '\n');
+    EXPECT_EQ(c.line(), 2);
+    EXPECT_EQ(c.column(), 1);
+    EXPECT_EQ(c.peek(), 'c');
+    EXPECT_EQ(c.get(), 'c');
+    EXPECT_EQ(c.get(), 'd');
+    EXPECT_EQ(c.get(), EOF);
+    EXPECT_FALSE(c);
+}
+
+TEST(Cursor, PutbackAcrossNewlineRestoresColumn)
+{
+    auto path = write_file("cursor.txt", "abc\nd");
+    mapped_source ms(path.c_str());
+    cursor c(ms);
+
+    for (int i = 0; i < 4; ++i)
+        c.get();
+    EXPECT_EQ(c.line(), 2);
+
+    c.putback(); // back onto '\n'
+    EXPECT_EQ(c.line(), 1);
+    EXPECT_EQ(c.column(), 4);
+    EXPECT_EQ(c.position(), 3);
+}
+
+TEST(Cursor, CursorsAreIndependent)
+{
+    auto path = write_file("cursor.txt", "one two");
+    mapped_source ms(path.c_str());
+    cursor a(ms);
+    cursor b(ms);
+
+    std::string wa, wb;
+    a >> wa >> wa;
+    b >> wb;
+
+    EXPECT_EQ(wa, "two");
+    EXPECT_EQ(wb, "one");
+}
+
+TEST(Cursor, SeekByOffsetUsesIndex)
+{
+    auto path = write_file("cursor.txt", "abc\ndef\nghi");
+    mapped_source ms(path.c_str());
+    cursor c(ms);
+
+    c.seek(std::size_t{9});
+    EXPECT_EQ(c.line(), 3);
+    EXPECT_EQ(c.column(), 2);
+    EXPECT_EQ(c.get(), 'h');
+    EXPECT_TRUE(ms.has_index());
+}
+
+TEST(Cursor, BookmarkRestoresState)
+{
+    auto path = write_file("cursor.txt", "12 34\n56");
+    mapped_source ms(path.c_str());
+    cursor c(ms);
+
+    int a, b, d;
+    c >> a;
+    bookmark m = c.mark();
+    c >> b >> d;
+    EXPECT_EQ(d, 56);
+
+    c.seek(m);
+    c >> b;
+    EXPECT_EQ(a, 12);
+    EXPECT_EQ(b, 34);
+}
+
+TEST(Cursor, FollowsDetectedLineEnding)
+{
+    auto path = write_file("cursor.txt", "ab\r\ncd\r\nef");
+    mapped_source ms(path.c_str());
+    EXPECT_EQ(ms.endings(), mms::line_ending::crlf);
+
+    cursor c(ms);
+    for (int i = 0; i < 4; ++i)
+        c.get();
+    EXPECT_EQ(c.line(), 2);
+    EXPECT_EQ(c.column(), 1);
+
+    c.putback();
+    EXPECT_EQ(c.line(), 1);
+    EXPECT_EQ(c.column(), 3);
+
+    c.seek(std::size_t{9});
+    EXPECT_EQ(c.line(), 3);
+    EXPECT_EQ(c.column(), 2);
+}
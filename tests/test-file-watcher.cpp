@@ -0,0 +1,182 @@
+#include <poll.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+using mms::source;
+
+extern fs::path exeDir;
+
+// Helper: numbered lines "line <i>\n"
+static std::string numbered_lines(int from, int to)
+{
+    std::string text;
+    for (int i = from; i <= to; ++i)
+        text += "line " + std::to_string(i) + "\n";
+    return text;
+}
+
+// Helper: replace a file the way editors do, via a temporary and rename
+static void save(const fs::path &path, const std::string &content)
+{
+    fs::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out << content;
+    }
+    fs::rename(tmp, path);
+}
+
+TEST(Reload, FindsChangedRegionAndUpdatesIndex)
+{
+    auto path = exeDir / "data" / "reload.txt";
+    std::string text = numbered_lines(1, 20000);
+    save(path, text);
+
+    source s(path.c_str());
+    s.enable_change_tracking();
+    s.index(); // built before the change, updated incrementally after it
+
+    std::size_t at = text.find("line 10000\n");
+    text.replace(at, 10, "line ten thousand\nand one more");
+    save(path, text);
+
+    ASSERT_TRUE(s.reload());
+    EXPECT_EQ(s.generation(), 1u);
+    auto c = s.last_change();
+    EXPECT_LE(c.begin, at);
+    EXPECT_GE(c.old_end, at + 10);
+    EXPECT_LT(c.old_end - c.begin, 3 * 4096); // only the blocks around the edit
+    EXPECT_EQ(c.new_end - c.old_end, 20u);
+
+    mms::line_index fresh(text.data(), text.size());
+    EXPECT_EQ(s.index().newline_positions(), fresh.newline_positions());
+    EXPECT_EQ(s.size(), text.size());
+    EXPECT_FALSE(s.reload()); // nothing new
+}
+
+TEST(Reload, KeepsRequestedEncoding)
+{
+    auto path = exeDir / "data" / "reload-latin1.txt";
+    save(path, "caf\xE9\n");
+
+    source s(path.c_str(), mms::line_ending::detect, mms::encoding::latin1);
+    s.enable_change_tracking();
+    save(path, "caf\xE9 au lait\n");
+
+    ASSERT_TRUE(s.reload());
+    EXPECT_EQ(std::string(s.data(), s.size()), "caf\xC3\xA9 au lait\n");
+}
+
+TEST(Reload, BookmarksMoveOrAreInvalidated)
+{
+    auto path = exeDir / "data" / "reload_marks.txt";
+    std::string text = numbered_lines(1, 5000);
+    save(path, text);
+
+    source s(path.c_str());
+    s.enable_change_tracking();
+    std::string word;
+    int n;
+    s >> word >> n;
+    auto early = s.mark(); // after "line 1"
+
+    std::size_t mid = text.find("line 2500\n");
+    s.seek(mid);
+    auto inside = s.mark();
+    std::size_t late_pos = text.find("line 4000\n");
+    s.seek(late_pos);
+    auto late = s.mark();
+    EXPECT_EQ(late.line(), 4000);
+
+    text.insert(mid, "inserted\nlines\n");
+    save(path, text);
+    ASSERT_TRUE(s.reload());
+
+    // The reading position moved with the text
+    EXPECT_EQ(s.position(), late_pos + 15);
+    EXPECT_EQ(s.line(), 4002);
+    s >> word >> n;
+    EXPECT_EQ(n, 4000);
+
+    mms::bookmark b = late;
+    ASSERT_TRUE(s.rebase(b));
+    EXPECT_EQ(b.position(), late_pos + 15);
+    EXPECT_EQ(b.line(), 4002);
+    EXPECT_EQ(b.generation(), 1u);
+
+    s.seek(early); // before the change: unchanged
+    EXPECT_EQ(s.line(), 1);
+    s >> word >> n;
+    EXPECT_EQ(n, 2);
+    EXPECT_THROW(s.seek(inside), std::invalid_argument);
+}
+
+TEST(FileWatcher, ReloadsOnSave)
+{
+    auto path = exeDir / "data" / "watched.txt";
+    save(path, numbered_lines(1, 100));
+
+    source s(path.c_str());
+    mms::file_watcher w;
+    w.add(s);
+    EXPECT_TRUE(w.poll(0).empty());
+
+    save(path, numbered_lines(1, 50) + "changed\n" + numbered_lines(51, 100));
+    std::vector<source *> changed;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (changed.empty() && std::chrono::steady_clock::now() < deadline)
+        changed = w.poll(50);
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0], &s);
+    EXPECT_EQ(s.index().lines(), 102u);
+
+    // Removing the last source of the directory drops its inotify watch
+    w.remove(s);
+    w.poll(0);
+    save(path, "gone\n");
+    pollfd pfd{w.descriptor(), POLLIN, 0};
+    EXPECT_EQ(::poll(&pfd, 1, 100), 0);
+}
+
+TEST(FileWatcher, ForgetsDeletedDirectory)
+{
+    auto dir = exeDir / "data" / "watched-dir";
+    fs::create_directories(dir);
+    auto path = dir / "a.txt";
+    save(path, "one\n");
+
+    mms::file_watcher w;
+    {
+        source gone(path.c_str());
+        w.add(gone);
+        fs::remove_all(dir);
+    }
+    // The kernel drops the watch once nothing in the directory is open
+    EXPECT_TRUE(w.poll(100).empty());
+
+    // A recreated directory of the same name gets a fresh watch
+    fs::create_directories(dir);
+    save(path, "one\n");
+    source s(path.c_str());
+    w.add(s);
+    save(path, "two\n");
+    std::vector<source *> changed;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (changed.empty() && std::chrono::steady_clock::now() < deadline)
+        changed = w.poll(50);
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0], &s);
+
+    w.remove(s);
+    fs::remove_all(dir);
+}
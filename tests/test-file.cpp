@@ -64,3 +64,44 @@ TEST(MappedFile, InvalidPathThrowsException)
 {
     EXPECT_THROW(file("data/this-file-does-not-exist.txt"), std::ios_base::failure);
 }
+
+TEST(File, OpenReportsErrorsWithoutThrowing)
+{
+    mms::result<file> missing = file::open("data/this-file-does-not-exist.txt");
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error(), std::errc::no_such_file_or_directory);
+
+    auto path = data_file("test-plain-text.txt");
+    mms::result<file> f = file::open(path.c_str());
+    ASSERT_TRUE(f);
+    EXPECT_FALSE(f.error());
+    EXPECT_EQ(std::string(f->data(), f->size()), read_file(path));
+    EXPECT_EQ(f->path(), path.string());
+
+    auto empty = data_file("file_open_empty.txt");
+    std::ofstream(empty).close();
+    mms::result<file> e = file::open(empty.c_str());
+    ASSERT_TRUE(e);
+    EXPECT_EQ(e->size(), 0u);
+}
+
+TEST(File, AdoptsDescriptorAndMoves)
+{
+    auto path = data_file("file_fd.txt");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "descriptor";
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    ASSERT_NE(fd, -1);
+    file f(fd, 10);
+    file g(std::move(f));
+    EXPECT_FALSE(f.is_open());
+    ASSERT_TRUE(g.is_open());
+    EXPECT_EQ(std::string(g.data(), g.size()), "descriptor");
+
+    mms::source s(std::move(g));
+    std::string word;
+    s >> word;
+    EXPECT_EQ(word, "descriptor");
+}
@@ -0,0 +1,104 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::intern_pool;
+using mms::symbol;
+
+TEST(InternPool, EqualStringsShareHandleAndStorage)
+{
+    intern_pool pool;
+    symbol a = pool.intern("label");
+    std::string copy = "label";
+    symbol b = pool.intern(copy);
+    symbol c = pool.intern("other");
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(pool.view(a).data(), pool.view(b).data());
+    EXPECT_EQ(pool[c], "other");
+    EXPECT_EQ(pool.view(a).data()[5], '\0');
+    EXPECT_EQ(pool.intern(""), symbol{});
+    EXPECT_EQ(pool.size(), 3u);
+    EXPECT_EQ(*pool.find("other"), c);
+    EXPECT_FALSE(pool.find("missing"));
+}
+
+TEST(InternPool, ViewsSurviveGrowth)
+{
+    intern_pool pool;
+    std::vector<symbol> symbols;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 50000; ++i)
+    {
+        symbols.push_back(pool.intern("id" + std::to_string(i)));
+        views.push_back(pool.view(symbols.back()));
+    }
+    symbols.push_back(pool.intern(std::string(100000, 'x'))); // larger than a block
+
+    for (int i = 0; i < 50000; i += 997)
+    {
+        EXPECT_EQ(pool.intern("id" + std::to_string(i)), symbols[i]);
+        EXPECT_EQ(pool.view(symbols[i]).data(), views[i].data());
+    }
+    EXPECT_EQ(pool.view(symbols.back()).size(), 100000u);
+    EXPECT_EQ(pool.size(), 50002u);
+
+    std::unordered_map<symbol, int> counts;
+    ++counts[symbols[3]];
+    EXPECT_EQ(counts.count(pool.intern("id3")), 1u);
+
+    pool.clear();
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_EQ(pool.bytes(), 0u);
+    EXPECT_FALSE(pool.find("id3"));
+}
+
+TEST(InternPool, MovedFromPoolIsEmptyAndUsable)
+{
+    intern_pool a;
+    symbol x = a.intern("alpha");
+
+    intern_pool b(std::move(a));
+    EXPECT_EQ(b[x], "alpha");
+    EXPECT_EQ(a.size(), 1u);
+    EXPECT_FALSE(a.find("alpha"));
+    symbol y = a.intern("beta");
+    EXPECT_EQ(a[y], "beta");
+
+    intern_pool c;
+    c = std::move(b);
+    EXPECT_EQ(c.find("alpha"), x);
+    EXPECT_EQ(b.bytes(), 0u);
+    EXPECT_EQ(b[b.intern("gamma")], "gamma");
+}
+
+TEST(InternPool, ReadsSymbolsFromSource)
+{
+    std::string longword(300, 'w');
+    auto path = write_file("intern.txt", "ld a, b\n  ld b, a\n" + longword + " ld");
+    mms::source s(path.c_str());
+    intern_pool pool;
+
+    std::vector<symbol> read;
+    for (symbol sym = mms::read_symbol(s, pool); sym != symbol{}; sym = mms::read_symbol(s, pool))
+        read.push_back(sym);
+
+    ASSERT_EQ(read.size(), 8u);
+    EXPECT_EQ(read[0], read[3]);
+    EXPECT_EQ(read[0], read[7]);
+    EXPECT_EQ(pool[read[1]], "a,");
+    EXPECT_EQ(pool[read[6]], longword);
+    EXPECT_EQ(read[2], pool.intern("b"));
+    EXPECT_EQ(pool.size(), 7u); // "", "ld", "a,", "b", "b,", "a" and the long word
+}
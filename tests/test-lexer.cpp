@@ -0,0 +1,157 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+using mms::charset;
+using mms::lexeme;
+using mms::source;
+
+extern fs::path exeDir;
+
+// Token ids for a small C-like language
+enum : std::uint16_t
+{
+    IDENT = 1,
+    NUMBER,
+    STRING,
+    PLUS,
+    PLUS_EQ,
+    INCR,
+    ARROW,
+    MINUS,
+    ASSIGN,
+    EQ,
+    SEMI,
+    LPAREN,
+    RPAREN,
+    KW_IF,
+    KW_ELSE,
+    KW_RETURN,
+    KW_WHILE
+};
+
+static constexpr auto spec = []
+{
+    mms::lexer_spec<> s;
+    s.skip(charset::space())
+        .line_comment("//")
+        .block_comment("/*", "*/")
+        .identifier(IDENT)
+        .number(NUMBER)
+        .quoted(STRING, '"')
+        .literal(PLUS, "+")
+        .literal(PLUS_EQ, "+=")
+        .literal(INCR, "++")
+        .literal(ARROW, "->")
+        .literal(MINUS, "-")
+        .literal(ASSIGN, "=")
+        .literal(EQ, "==")
+        .literal(SEMI, ";")
+        .literal(LPAREN, "(")
+        .literal(RPAREN, ")");
+    return s;
+}();
+
+static constexpr auto table = mms::make_dfa(spec);
+
+static constexpr mms::keyword_table<8> keywords{
+    {"if", KW_IF}, {"else", KW_ELSE}, {"return", KW_RETURN}, {"while", KW_WHILE}};
+
+// Helper: collect (id, text) pairs until end of input
+static std::vector<std::pair<std::uint16_t, std::string>> lex_all(mms::dfa_lexer &lx)
+{
+    std::vector<std::pair<std::uint16_t, std::string>> out;
+    for (lexeme t = lx.next(); t.id != mms::lex::end; t = lx.next())
+        out.emplace_back(t.id, std::string(t.text));
+    return out;
+}
+
+TEST(Lexer, TableIsBuiltAtCompileTime)
+{
+    static_assert(table.state_count > 2);
+    static_assert(table.class_count < 64);
+    static_assert(keywords.find("while") == KW_WHILE);
+    static_assert(keywords.find("whale") == 0);
+    EXPECT_LT(table.class_count, 32u); // far fewer classes than bytes
+}
+
+TEST(Lexer, LongestMatchAndRulePriority)
+{
+    mms::dfa_lexer lx(table.view(), "a+=b++ -> - == = x1 3.25e-2 0x1F 42");
+    auto toks = lex_all(lx);
+    std::vector<std::pair<std::uint16_t, std::string>> expected = {
+        {IDENT, "a"}, {PLUS_EQ, "+="}, {IDENT, "b"}, {INCR, "++"}, {ARROW, "->"}, {MINUS, "-"}, {EQ, "=="}, {ASSIGN, "="}, {IDENT, "x1"}, {NUMBER, "3.25e-2"}, {NUMBER, "0x1F"}, {NUMBER, "42"}};
+    EXPECT_EQ(toks, expected);
+}
+
+TEST(Lexer, CommentsAndStringsAndKeywords)
+{
+    mms::dfa_lexer lx(table.view(), "if (x) /* a * / b */ return \"q\\\"s\"; // tail\nelse");
+    lx.use_keywords(keywords, IDENT);
+    auto toks = lex_all(lx);
+    std::vector<std::pair<std::uint16_t, std::string>> expected = {
+        {KW_IF, "if"}, {LPAREN, "("}, {IDENT, "x"}, {RPAREN, ")"}, {KW_RETURN, "return"}, {STRING, "\"q\\\"s\""}, {SEMI, ";"}, {KW_ELSE, "else"}};
+    EXPECT_EQ(toks, expected);
+}
+
+TEST(Lexer, ErrorBytesAndLocations)
+{
+    mms::dfa_lexer lx(table.view(), "a\n  @b");
+    lexeme t = lx.next();
+    EXPECT_EQ(t.id, IDENT);
+    EXPECT_EQ(t.where.line, 1u);
+    t = lx.next();
+    EXPECT_EQ(t.id, mms::lex::error);
+    EXPECT_EQ(t.text, "@");
+    EXPECT_EQ(t.where.line, 2u);
+    EXPECT_EQ(t.where.column, 3u);
+    t = lx.next();
+    EXPECT_EQ(t.id, IDENT);
+    EXPECT_EQ(t.where.offset, 5u);
+    EXPECT_EQ(lx.next().id, mms::lex::end);
+}
+
+TEST(Lexer, LocationsForCrAndCrlf)
+{
+    for (auto [text, endings] : {std::pair{"a\r\n  @b\r\n\r\nc", mms::line_ending::crlf},
+                                 std::pair{"a\r  @b\r\rc", mms::line_ending::cr}})
+    {
+        mms::dfa_lexer lx(table.view(), text, {}, endings);
+        EXPECT_EQ(lx.next().id, IDENT);
+        lexeme t = lx.next();
+        EXPECT_EQ(t.id, mms::lex::error);
+        EXPECT_EQ(t.where.line, 2u);
+        EXPECT_EQ(t.where.column, 3u);
+        EXPECT_EQ(lx.next().id, IDENT);
+        t = lx.next();
+        EXPECT_EQ(t.text, "c");
+        EXPECT_EQ(t.where.line, 4u);
+        EXPECT_EQ(t.where.column, 1u);
+    }
+}
+
+TEST(Lexer, RunsOverSourceFromCurrentPosition)
+{
+    auto path = exeDir / "data" / "lexer.c";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "skip\nwhile (n) n = n - 1;\n";
+    }
+    source s(path.c_str());
+    std::string first;
+    s >> first;
+    mms::dfa_lexer lx(table.view(), s);
+    lx.use_keywords(keywords, IDENT);
+    lexeme t = lx.next();
+    EXPECT_EQ(t.id, KW_WHILE);
+    EXPECT_EQ(t.where.line, 2u);
+    EXPECT_EQ(t.where.column, 1u);
+    EXPECT_EQ(lex_all(lx).size(), 9u);
+}
@@ -0,0 +1,157 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+using mms::line_index;
+
+TEST(LineIndex, EmptyBufferHasOneLine)
+{
+    line_index idx(nullptr, 0);
+    EXPECT_EQ(idx.lines(), 1);
+    EXPECT_EQ(idx.line_of(0), 1);
+    EXPECT_EQ(idx.column_of(0), 1);
+}
+
+TEST(LineIndex, RecordsNewlinePositions)
+{
+    std::string text = "ab\ncd\n\nx";
+    line_index idx(text.data(), text.size());
+
+    ASSERT_EQ(idx.lines(), 4);
+    const auto &nl = idx.newline_positions();
+    ASSERT_EQ(nl.size(), 3);
+    EXPECT_EQ(nl[0], 2);
+    EXPECT_EQ(nl[1], 5);
+    EXPECT_EQ(nl[2], 6);
+}
+
+TEST(LineIndex, ResolvesLineAndColumn)
+{
+    std::string text = "abc\ndef\nghi";
+    line_index idx(text.data(), text.size());
+
+    EXPECT_EQ(idx.line_of(0), 1);
+    EXPECT_EQ(idx.column_of(0), 1);
+
+    EXPECT_EQ(idx.line_of(3), 1); // the '\n' itself
+    EXPECT_EQ(idx.column_of(3), 4);
+
+    EXPECT_EQ(idx.line_of(5), 2); // 'e'
+    EXPECT_EQ(idx.column_of(5), 2);
+
+    EXPECT_EQ(idx.line_of(10), 3); // 'i'
+    EXPECT_EQ(idx.column_of(10), 3);
+}
+
+TEST(LineIndex, LineStartOffsets)
+{
+    std::string text = "abc\ndef\nghi";
+    line_index idx(text.data(), text.size());
+
+    EXPECT_EQ(idx.line_start(1), 0);
+    EXPECT_EQ(idx.line_start(2), 4);
+    EXPECT_EQ(idx.line_start(3), 8);
+    EXPECT_THROW(idx.line_start(4), std::out_of_range);
+}
+
+TEST(LineIndex, DetectsLineEndings)
+{
+    std::string lf = "a\nb\nc\n";
+    std::string crlf = "a\r\nb\r\nc\n";
+    std::string cr = "a\rb\rc";
+    std::string none = "abc";
+
+    EXPECT_EQ(mms::detect_line_ending(lf.data(), lf.size()), mms::line_ending::lf);
+    EXPECT_EQ(mms::detect_line_ending(crlf.data(), crlf.size()), mms::line_ending::crlf);
+    EXPECT_EQ(mms::detect_line_ending(cr.data(), cr.size()), mms::line_ending::cr);
+    EXPECT_EQ(mms::detect_line_ending(none.data(), none.size()), mms::line_ending::lf);
+}
+
+TEST(LineIndex, DetectsCrlfAcrossBlockBoundary)
+{
+    // Put a "\r\n" pair across the 16-byte SIMD block boundary
+    std::string text(15, 'x');
+    text += "\r\n";
+    text += std::string(40, 'y');
+    text += "\r\n";
+
+    EXPECT_EQ(mms::detect_line_ending(text.data(), text.size()), mms::line_ending::crlf);
+}
+
+TEST(LineIndex, CrlfColumns)
+{
+    std::string text = "abc\r\ndef\r\n";
+    line_index idx(text.data(), text.size(), mms::line_ending::detect);
+
+    EXPECT_EQ(idx.endings(), mms::line_ending::crlf);
+    EXPECT_EQ(idx.lines(), 3);
+    EXPECT_EQ(idx.column_of(3), 4); // '\r'
+    EXPECT_EQ(idx.column_of(4), 4); // '\n' takes the column of '\r'
+    EXPECT_EQ(idx.line_of(5), 2);
+    EXPECT_EQ(idx.column_of(5), 1);
+}
+
+TEST(LineIndex, CarriageReturnBreaks)
+{
+    std::string text = "ab\rcd\r";
+    line_index idx(text.data(), text.size(), mms::line_ending::cr);
+
+    EXPECT_EQ(idx.lines(), 3);
+    EXPECT_EQ(idx.line_of(4), 2);
+    EXPECT_EQ(idx.column_of(4), 2);
+    EXPECT_EQ(idx.line_start(2), 3);
+}
+
+TEST(LineIndex, LongBufferMatchesScalarCount)
+{
+    std::string text;
+    for (int i = 0; i < 1000; ++i)
+        text += std::string(i % 37, 'x') + "\n";
+
+    line_index idx(text.data(), text.size());
+    EXPECT_EQ(idx.lines(), 1001);
+    for (std::size_t i = 0, n = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\n')
+        {
+            EXPECT_EQ(idx.newline_positions()[n++], i);
+        }
+    }
+}
+
+TEST(LineIndex, IncrementalUpdateMatchesRebuild)
+{
+    std::string before = "one\r\ntwo\r\nthree\r\nfour\r\nfive\r\n";
+    struct edit
+    {
+        std::size_t begin, length;
+        std::string with;
+    } edits[] = {
+        {5, 3, "TWO\r\nand a half"}, // replace a line, adding one
+        {0, 0, "\n"},                // insert at the start
+        {3, 2, "x"},                 // split a CRLF pair
+        {12, 100, ""},               // truncate
+    };
+
+    for (auto endings : {mms::line_ending::lf, mms::line_ending::crlf})
+    {
+        std::string text = before;
+        line_index idx(text.data(), text.size(), endings);
+        for (const auto &e : edits)
+        {
+            std::size_t len = std::min(e.length, text.size() - e.begin);
+            text.replace(e.begin, len, e.with);
+            idx.update(text.data(), e.begin, e.begin + len, e.begin + e.with.size());
+
+            line_index fresh(text.data(), text.size(), endings);
+            EXPECT_EQ(idx.newline_positions(), fresh.newline_positions());
+            for (std::size_t p = 0; p <= text.size(); ++p)
+            {
+                EXPECT_EQ(idx.line_of(p), fresh.line_of(p));
+                EXPECT_EQ(idx.column_of(p), fresh.column_of(p)) << "at " << p;
+            }
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#if MMS_TEST_PARALLEL
+#include <execution>
+#endif
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::source;
+
+static_assert(std::random_access_iterator<mms::line_range::iterator>);
+static_assert(std::ranges::random_access_range<mms::line_range>);
+static_assert(std::ranges::sized_range<mms::line_range>);
+static_assert(std::ranges::view<mms::line_range>);
+static_assert(std::ranges::borrowed_range<mms::line_range>);
+
+TEST(Lines, YieldsNumberedLinesWithoutTerminators)
+{
+    auto path = write_file("lines.txt", "alpha\n\nbeta\ngamma");
+    source s(path.c_str());
+
+    std::vector<std::string> text;
+    std::vector<std::size_t> numbers;
+    for (auto [number, line] : s.lines())
+    {
+        numbers.push_back(number);
+        text.emplace_back(line);
+    }
+    EXPECT_EQ(text, (std::vector<std::string>{"alpha", "", "beta", "gamma"}));
+    EXPECT_EQ(numbers, (std::vector<std::size_t>{1, 2, 3, 4}));
+}
+
+TEST(Lines, TrailingBreakEndsTheLastLine)
+{
+    auto path = write_file("lines-trailing.txt", "one\ntwo\n");
+    source s(path.c_str());
+    EXPECT_EQ(s.lines().size(), 2u);
+    EXPECT_EQ(s.lines().back().text, "two");
+
+    auto empty = write_file("lines-empty.txt", "");
+    source e(empty.c_str());
+    EXPECT_TRUE(e.lines().empty());
+}
+
+TEST(Lines, StripsCarriageReturnsOfCrlf)
+{
+    auto path = write_file("lines-crlf.txt", "a\r\nb\r\r\nc");
+    source s(path.c_str(), mms::line_ending::crlf);
+    auto lines = s.lines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0].text, "a");
+    EXPECT_EQ(lines[1].text, "b\r");
+    EXPECT_EQ(lines[2].text, "c");
+
+    auto mac = write_file("lines-cr.txt", "x\ry\r");
+    source m(mac.c_str(), mms::line_ending::cr);
+    ASSERT_EQ(m.lines().size(), 2u);
+    EXPECT_EQ(m.lines()[1].text, "y");
+}
+
+TEST(Lines, RandomAccessAgreesWithIndex)
+{
+    std::string content;
+    for (int i = 0; i < 1000; ++i)
+        content += std::string(i % 13, 'x') + std::to_string(i) + "\n";
+    auto path = write_file("lines-many.txt", content);
+    source s(path.c_str());
+
+    auto lines = s.lines();
+    ASSERT_EQ(lines.size(), 1000u);
+    auto it = lines.begin() + 500;
+    EXPECT_EQ((*it).number, 501u);
+    EXPECT_EQ(it[-1].number, 500u);
+    EXPECT_EQ(lines.end() - it, 500);
+    for (std::size_t i : {0, 1, 499, 999})
+        EXPECT_EQ(lines[i].text.data() - s.data(), static_cast<std::ptrdiff_t>(s.index().line_start(i + 1)));
+
+    auto found = std::ranges::lower_bound(lines, 700, {}, [](const mms::line_entry &l) { return l.number; });
+    EXPECT_EQ((*found).text, std::string(699 % 13, 'x') + "699");
+}
+
+TEST(Lines, ComposesWithViews)
+{
+    auto path = write_file("lines-views.txt", "# comment\nkey=1\n\n# other\nname=two\n");
+    source s(path.c_str());
+
+    std::vector<std::size_t> numbers;
+    for (const auto &l : s.lines() | std::views::filter([](const mms::line_entry &l) {
+                             return !l.text.empty() && l.text[0] != '#';
+                         }))
+        numbers.push_back(l.number);
+    EXPECT_EQ(numbers, (std::vector<std::size_t>{2, 5}));
+
+    auto reversed = s.lines() | std::views::reverse | std::views::take(1);
+    EXPECT_EQ((*reversed.begin()).text, "name=two");
+}
+
+TEST(Lines, WorksWithParallelAlgorithms)
+{
+    std::string content;
+    for (int i = 1; i <= 5000; ++i)
+        content += std::to_string(i) + "\n";
+    auto path = write_file("lines-parallel.txt", content);
+    source s(path.c_str());
+    auto lines = s.lines();
+
+    std::atomic<std::size_t> total{0};
+    auto add = [&](const mms::line_entry &l) { total += std::stoul(std::string(l.text)); };
+#if MMS_TEST_PARALLEL
+    std::for_each(std::execution::par, lines.begin(), lines.end(), add);
+#else
+    std::for_each(lines.begin(), lines.end(), add);
+#endif
+    EXPECT_EQ(total.load(), 5000u * 5001u / 2);
+}
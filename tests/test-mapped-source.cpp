@@ -0,0 +1,110 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+using mms::cursor;
+using mms::line_index;
+using mms::mapped_source;
+
+extern fs::path exeDir;
+
+// Helper: path to file in bin/data/
+static fs::path data_file(const std::string &name)
+{
+    return exeDir / "data" / name;
+}
+
+TEST(MappedSource, MapsWholeFile)
+{
+    auto path = data_file("test-plain-text.txt");
+    mapped_source ms(path.c_str());
+
+    std::ifstream in(path, std::ios::binary);
+    std::string expected(std::istreambuf_iterator<char>(in), {});
+
+    ASSERT_EQ(ms.size(), expected.size());
+    EXPECT_EQ(std::string(ms.data(), ms.size()), expected);
+}
+
+TEST(MappedSource, IndexIsBuiltLazilyAndOnce)
+{
+    auto path = data_file("test-plain-text.txt");
+    mapped_source ms(path.c_str());
+
+    EXPECT_FALSE(ms.has_index());
+    const line_index &a = ms.index();
+    EXPECT_TRUE(ms.has_index());
+    const line_index &b = ms.index();
+    EXPECT_EQ(&a, &b);
+    EXPECT_GE(a.lines(), 4);
+}
+
+TEST(MappedSource, ConcurrentIndexBuildPublishesSingleIndex)
+{
+    auto path = exeDir / "data" / "many-lines.txt";
+    {
+        std::ofstream out(path);
+        for (int i = 0; i < 10000; ++i)
+            out << "line " << i << '\n';
+    }
+
+    mapped_source ms(path.c_str());
+    auto before = mms::global_stats();
+
+    constexpr int threads = 8;
+    std::vector<const line_index *> seen(threads, nullptr);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t]
+                          { seen[t] = &ms.index(); });
+    for (auto &th : pool)
+        th.join();
+
+    for (auto *idx : seen)
+        EXPECT_EQ(idx, seen[0]);
+    EXPECT_EQ(seen[0]->lines(), 10001);
+    if constexpr (mms::stats_enabled)
+    {
+        EXPECT_EQ(mms::global_stats().index_builds - before.index_builds, 1u);
+    }
+}
+
+TEST(MappedSource, IndependentCursorsOnManyThreads)
+{
+    auto path = exeDir / "data" / "words.txt";
+    {
+        std::ofstream out(path);
+        for (int i = 0; i < 1000; ++i)
+            out << "w" << i << (i % 10 == 9 ? '\n' : ' ');
+    }
+
+    mapped_source ms(path.c_str());
+
+    constexpr int threads = 4;
+    std::vector<int> counts(threads, 0);
+    std::vector<int> last_lines(threads, 0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t]
+                          {
+                              cursor c(ms);
+                              std::string word;
+                              while (c >> word && !word.empty())
+                                  ++counts[t];
+                              last_lines[t] = c.line(); });
+    for (auto &th : pool)
+        th.join();
+
+    for (int t = 0; t < threads; ++t)
+    {
+        EXPECT_EQ(counts[t], 1000);
+        EXPECT_EQ(last_lines[t], 101);
+    }
+}
@@ -0,0 +1,139 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::overlay;
+using mms::source;
+
+// Helper: read the document through get(), checking line/column against a line index
+static void check_reader(overlay &o, const std::string &expected, mms::line_ending endings)
+{
+    mms::line_index idx(expected.data(), expected.size(), endings);
+    o.seek(std::size_t{0});
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_EQ(o.line(), idx.line_of(i)) << "at " << i;
+        ASSERT_EQ(o.column(), idx.column_of(i)) << "at " << i;
+        ASSERT_EQ(o.get(), static_cast<unsigned char>(expected[i]));
+    }
+    EXPECT_EQ(o.get(), EOF);
+    EXPECT_FALSE(o);
+}
+
+TEST(Overlay, EditsLeaveOriginalUntouched)
+{
+    auto path = write_file("overlay.txt", "hello\nworld\n");
+    source s(path.c_str());
+    overlay o(s);
+
+    o.replace(0, 5, "goodbye");
+    o.insert(o.size(), "again\n");
+    o.erase(8, 6);
+    EXPECT_EQ(o.str(), "goodbye\nagain\n");
+    EXPECT_EQ(std::string(s.data(), s.size()), "hello\nworld\n");
+    EXPECT_EQ(o.lines(), 3u);
+    EXPECT_EQ(o.line_start(2), 8u);
+    EXPECT_EQ(o.generation(), 3u);
+    check_reader(o, o.str(), mms::line_ending::lf);
+}
+
+TEST(Overlay, RandomEditsMatchModel)
+{
+    std::string text;
+    for (int i = 0; i < 400; ++i)
+        text += "line " + std::to_string(i) + (i % 3 ? "\r\n" : "\n");
+
+    for (auto endings : {mms::line_ending::lf, mms::line_ending::crlf})
+    {
+        auto path = write_file("overlay_random.txt", text);
+        source s(path.c_str(), endings);
+        overlay o(s);
+        std::string model = text;
+
+        std::mt19937 rng(7);
+        const char *inserts[] = {"x", "\n", "ab\ncd", "\r\n", "\r", "word "};
+        for (int step = 0; step < 300; ++step)
+        {
+            std::size_t pos = rng() % (model.size() + 1);
+            std::size_t len = rng() % 3 == 0 ? rng() % 40 : 0;
+            len = std::min(len, model.size() - pos);
+            std::string with = rng() % 4 == 0 ? "" : inserts[rng() % 6];
+            model.replace(pos, len, with);
+            o.replace(pos, len, with);
+            ASSERT_EQ(o.size(), model.size());
+        }
+        ASSERT_EQ(o.str(), model);
+
+        mms::line_index idx(model.data(), model.size(), endings);
+        EXPECT_EQ(o.lines(), idx.lines());
+        for (std::size_t p = 0; p <= model.size(); p += 7)
+        {
+            ASSERT_EQ(o.line_of(p), idx.line_of(p)) << "at " << p;
+            ASSERT_EQ(o.column_of(p), idx.column_of(p)) << "at " << p;
+        }
+        for (std::size_t l = 1; l <= idx.lines(); ++l)
+            ASSERT_EQ(o.line_start(l), idx.line_start(l));
+        check_reader(o, model, endings);
+    }
+}
+
+TEST(Overlay, TypingKeepsPieceCountLow)
+{
+    auto path = write_file("overlay_typing.txt", std::string(100000, 'a'));
+    source s(path.c_str());
+    overlay o(s);
+    std::string typed = "int main() {\n    return 0;\n}\n";
+    for (std::size_t i = 0; i < typed.size(); ++i)
+        o.insert(50000 + i, typed.substr(i, 1));
+    EXPECT_EQ(o.pieces(), 3u);
+    EXPECT_EQ(o.lines(), 4u);
+    EXPECT_EQ(o.line_of(50000 + typed.size()), 4);
+}
+
+TEST(Overlay, ReaderAndBookmarksFollowEdits)
+{
+    auto path = write_file("overlay_marks.txt", "alpha beta\ngamma delta\n");
+    source s(path.c_str());
+    overlay o(s);
+
+    std::string word;
+    o >> word;
+    EXPECT_EQ(word, "alpha");
+    auto before = o.mark();
+    o >> word >> word;
+    EXPECT_EQ(word, "gamma");
+    auto after = o.mark();
+
+    o.insert(0, "// header\n");
+    EXPECT_EQ(o.line(), 3); // the reader moved with the text
+    o >> word;
+    EXPECT_EQ(word, "delta");
+
+    o.seek(before);
+    EXPECT_EQ(o.position(), 15u);
+    EXPECT_EQ(o.line(), 2);
+    o.seek(after);
+    EXPECT_EQ(o.line(), 3);
+    EXPECT_EQ(o.column(), 6);
+
+    std::size_t at = o.str().find("beta");
+    o.seek(at + 2);
+    auto inside = o.mark();
+    o.replace(at, 4, "x");
+    EXPECT_THROW(o.seek(inside), std::invalid_argument);
+    EXPECT_EQ(o.position(), at); // moved to the start of the replaced text
+
+    EXPECT_EQ(o.get(), 'x');
+    o.putback();
+    o.putback(); // across the piece boundary, back into the original
+    EXPECT_EQ(o.get(), ' ');
+    EXPECT_EQ(o.get(), 'x');
+}
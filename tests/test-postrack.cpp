@@ -1,3 +1,5 @@
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include <mms/mms.h>
@@ -167,3 +169,137 @@ TEST(Postrack, SeekToMiddleOfLine)
     EXPECT_EQ(p.line(), 2);
     EXPECT_EQ(p.column(), 2);
 }
+
+TEST(Postrack, CrlfCarriageReturnTakesNoColumn)
+{
+    const char *text = "ab\r\ncd";
+    postrack p(mms::line_ending::crlf);
+    p.attach(text, 6);
+    for (const char *c = text; *c; ++c)
+        p.update_position(*c);
+
+    EXPECT_EQ(p.line(), 2);
+    EXPECT_EQ(p.column(), 3);
+
+    p.adjust_position_on_putback('d');
+    p.adjust_position_on_putback('c');
+    p.adjust_position_on_putback('\n'); // onto '\n'
+    EXPECT_EQ(p.line(), 1);
+    EXPECT_EQ(p.column(), 3);
+
+    p.adjust_position_on_putback('\r'); // onto '\r'
+    EXPECT_EQ(p.column(), 3);
+
+    p.set_position(3);
+    EXPECT_EQ(p.line(), 1);
+    EXPECT_EQ(p.column(), 3);
+}
+
+TEST(Postrack, CrlfWithoutBufferTreatsEveryCarriageReturnAsTerminator)
+{
+    postrack p(mms::line_ending::crlf);
+    const char *text = "ab\r\nc";
+    for (const char *c = text; *c; ++c)
+        p.update_position(*c);
+
+    EXPECT_EQ(p.line(), 2);
+    EXPECT_EQ(p.column(), 2);
+
+    p.set_position(3); // the '\n'
+    EXPECT_EQ(p.column(), 3);
+}
+
+TEST(Postrack, CarriageReturnLineEndings)
+{
+    postrack p(mms::line_ending::cr);
+    const char *text = "ab\rcd\re";
+    for (const char *c = text; *c; ++c)
+        p.update_position(*c);
+
+    EXPECT_EQ(p.line(), 3);
+    EXPECT_EQ(p.column(), 2);
+
+    p.set_position(4); // 'd'
+    EXPECT_EQ(p.line(), 2);
+    EXPECT_EQ(p.column(), 2);
+
+    p.set_position(6);
+    p.adjust_position_on_putback('\r');
+    EXPECT_EQ(p.line(), 2);
+    EXPECT_EQ(p.column(), 3);
+}
+
+TEST(Postrack, DetectResolvedOnAttach)
+{
+    const char *text = "a\rb\rc";
+    postrack p(mms::line_ending::detect);
+    p.attach(text, 5);
+    EXPECT_EQ(p.endings(), mms::line_ending::cr);
+}
+
+TEST(Postrack, CodePointColumns)
+{
+    const char *text = "z\xC3\xA9ro \xE2\x82\xAC\nx"; // "zéro €\nx"
+    std::size_t size = std::char_traits<char>::length(text);
+    postrack p;
+    p.set_column_unit(mms::column_unit::code_points);
+    p.attach(text, size);
+    for (std::size_t i = 0; i < 9; ++i)
+        p.update_position(text[i]);
+    EXPECT_EQ(p.column(), 7); // after the euro sign
+
+    p.adjust_position_on_putback(text[8]);
+    p.adjust_position_on_putback(text[7]);
+    EXPECT_EQ(p.column(), 7); // continuation bytes take no column
+    p.adjust_position_on_putback(text[6]);
+    EXPECT_EQ(p.column(), 6);
+
+    for (std::size_t i = 6; i < 10; ++i)
+        p.update_position(text[i]);
+    EXPECT_EQ(p.line(), 2);
+    p.adjust_position_on_putback('\n');
+    EXPECT_EQ(p.column(), 7);
+
+    p.set_position(3); // 'r'
+    EXPECT_EQ(p.column(), 3);
+}
+
+TEST(Postrack, CodePointCheckpointsAgreeWithScan)
+{
+    std::string line;
+    for (int i = 0; i < 3000; ++i)
+        line += i % 3 ? "a" : "\xC3\xA9";
+    std::string text = "head\n" + line + "\ntail";
+
+    postrack p;
+    p.set_column_unit(mms::column_unit::code_points, 64);
+    p.attach(text.data(), text.size());
+    for (std::size_t i = 0; i < 5 + line.size() / 2; ++i)
+        p.update_position(text[i]);
+
+    // Columns resolved from checkpoints recorded while reading and after it
+    for (std::size_t pos : {5ul, 6ul, 69ul, 1000ul, 2000ul, 3500ul, 5ul + line.size()})
+    {
+        int expected = 1;
+        for (std::size_t i = 5; i < pos; ++i)
+            expected += (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80;
+        EXPECT_EQ(p.column_from(5, pos), expected) << pos;
+    }
+    EXPECT_THROW(p.set_column_unit(mms::column_unit::code_points, 0), std::invalid_argument);
+}
+
+TEST(Postrack, CodePointColumnsWithCrlf)
+{
+    const char *text = "\xC3\xA9\r\nb";
+    postrack p(mms::line_ending::crlf);
+    p.set_column_unit(mms::column_unit::code_points);
+    p.attach(text, 5);
+    for (const char *c = text; *c; ++c)
+        p.update_position(*c);
+    EXPECT_EQ(p.line(), 2);
+
+    p.set_position(3); // the '\n'
+    EXPECT_EQ(p.column(), 2);
+    p.set_position(2); // the '\r'
+    EXPECT_EQ(p.column(), 2);
+}
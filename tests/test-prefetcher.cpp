@@ -0,0 +1,117 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+using mms::prefetch_mode;
+using mms::prefetch_options;
+using mms::source;
+
+extern fs::path exeDir;
+
+// Helper: create a file of the given size with a repeating pattern
+static fs::path make_large_file(const std::string &name, std::size_t size)
+{
+    auto path = exeDir / "data" / name;
+    std::ofstream out(path, std::ios::binary);
+    for (std::size_t i = 0; i < size; ++i)
+        out.put(i % 64 == 63 ? '\n' : static_cast<char>('a' + i % 26));
+    return path;
+}
+
+// Helper: read the whole source and return the number of lines seen
+static int read_all(source &s, std::size_t &bytes)
+{
+    bytes = 0;
+    while (s.get() != EOF)
+        ++bytes;
+    return s.line();
+}
+
+TEST(Prefetcher, DisabledReportsZero)
+{
+    auto path = make_large_file("prefetch.txt", 256 * 1024);
+    source s(path.c_str());
+
+    std::size_t bytes;
+    read_all(s, bytes);
+
+    auto st = s.prefetch_statistics();
+    EXPECT_EQ(st.requests, 0);
+    EXPECT_EQ(st.pages_advised, 0);
+}
+
+TEST(Prefetcher, AdviseModeIssuesRequestsEveryStep)
+{
+    constexpr std::size_t size = 512 * 1024;
+    auto path = make_large_file("prefetch.txt", size);
+    source s(path.c_str());
+
+    prefetch_options opts;
+    opts.mode = prefetch_mode::advise;
+    opts.distance = 64 * 1024;
+    opts.step = 16 * 1024;
+    s.enable_prefetch(opts);
+
+    std::size_t bytes;
+    int lines = read_all(s, bytes);
+
+    EXPECT_EQ(bytes, size);
+    EXPECT_EQ(lines, static_cast<int>(size / 64) + 1);
+
+    auto st = s.prefetch_statistics();
+    EXPECT_GE(st.requests, (size - opts.distance) / opts.step);
+    EXPECT_GE(st.pages_advised, size / 4096);
+    EXPECT_LE(st.faults_absorbed, st.pages_advised);
+}
+
+TEST(Prefetcher, ThreadModeReadsSameContent)
+{
+    constexpr std::size_t size = 512 * 1024;
+    auto path = make_large_file("prefetch.txt", size);
+
+    std::string plain, prefetched;
+    {
+        source s(path.c_str());
+        while (s)
+            plain += static_cast<char>(s.get());
+    }
+    {
+        source s(path.c_str());
+        prefetch_options opts;
+        opts.mode = prefetch_mode::thread;
+        opts.distance = 128 * 1024;
+        opts.step = 32 * 1024;
+        s.enable_prefetch(opts);
+        while (s)
+            prefetched += static_cast<char>(s.get());
+
+        EXPECT_GE(s.prefetch_statistics().requests, 1);
+    }
+
+    EXPECT_EQ(plain, prefetched);
+}
+
+TEST(Prefetcher, SeekBackwardKeepsReading)
+{
+    auto path = make_large_file("prefetch.txt", 128 * 1024);
+    source s(path.c_str());
+
+    prefetch_options opts;
+    opts.step = 4096;
+    opts.distance = 16384;
+    s.enable_prefetch(opts);
+
+    auto start = s.mark();
+    std::size_t bytes;
+    read_all(s, bytes);
+    s.seek(start);
+    std::size_t again;
+    read_all(s, again);
+
+    EXPECT_EQ(bytes, again);
+}
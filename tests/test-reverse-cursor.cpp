@@ -0,0 +1,71 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::reverse_cursor;
+using mms::source;
+
+TEST(ReverseCursor, WalksLinesBackwards)
+{
+    reverse_cursor r("alpha\n\nbeta\ngamma");
+    EXPECT_EQ(r.previous(), "gamma");
+    EXPECT_EQ(r.line(), 4u);
+    EXPECT_EQ(r.previous(), "beta");
+    EXPECT_EQ(r.previous(), "");
+    EXPECT_EQ(r.line(), 2u);
+    EXPECT_EQ(r.previous(), "alpha");
+    EXPECT_EQ(r.offset(), 0u);
+    EXPECT_EQ(r.previous(), std::nullopt);
+    EXPECT_EQ(r.line(), 1u);
+
+    reverse_cursor empty("");
+    EXPECT_EQ(empty.previous(), std::nullopt);
+}
+
+TEST(ReverseCursor, AgreesWithLineRange)
+{
+    std::string content;
+    for (int i = 0; i < 3000; ++i)
+        content += std::string(i % 41, 'x') + (i % 5 ? "\r\n" : "\n");
+    content += "\n\r\n";
+    auto path = write_file("reverse.txt", content);
+    source s(path.c_str(), mms::line_ending::crlf);
+
+    auto lines = s.lines();
+    reverse_cursor r(s);
+    for (std::size_t i = lines.size(); i-- > 0;)
+    {
+        auto line = r.previous();
+        ASSERT_TRUE(line);
+        ASSERT_EQ(*line, lines[i].text) << i;
+        ASSERT_EQ(line->data(), lines[i].text.data());
+    }
+    EXPECT_FALSE(r.previous());
+}
+
+TEST(ReverseCursor, TailReturnsLastLinesInOrder)
+{
+    std::string content;
+    for (int i = 1; i <= 100000; ++i)
+        content += "line " + std::to_string(i) + "\n";
+    auto path = write_file("reverse-tail.txt", content);
+    source s(path.c_str());
+
+    reverse_cursor r(s);
+    auto last = r.tail(3);
+    EXPECT_EQ(last, (std::vector<std::string_view>{"line 99998", "line 99999", "line 100000"}));
+    EXPECT_EQ(r.line(), 99998u);
+    EXPECT_EQ(r.tail(2).back(), "line 99997");
+    EXPECT_EQ(r.line(), 99996u);
+
+    reverse_cursor all("a\rb\r", mms::line_ending::detect);
+    EXPECT_EQ(all.tail(10), (std::vector<std::string_view>{"a", "b"}));
+}
@@ -0,0 +1,151 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::pattern_set;
+using mms::source;
+
+// Helper: leftmost-longest, non-overlapping matches found the slow way
+static std::vector<std::pair<std::size_t, std::size_t>> model(const std::string &text,
+                                                              const std::vector<std::string> &patterns)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> out; // offset, pattern
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        std::size_t best = std::string::npos;
+        for (std::size_t k = 0; k < patterns.size(); ++k)
+            if (text.compare(i, patterns[k].size(), patterns[k]) == 0 &&
+                (best == std::string::npos || patterns[k].size() > patterns[best].size()))
+                best = k;
+        if (best == std::string::npos)
+        {
+            ++i;
+            continue;
+        }
+        out.emplace_back(i, best);
+        i += patterns[best].size();
+    }
+    return out;
+}
+
+TEST(Search, FindsNeedleWithLineAndColumn)
+{
+    auto path = write_file("search.txt", "int a;\n#pragma once\n  #pragma pack\n");
+    source s(path.c_str());
+
+    auto m = s.find("#pragma");
+    ASSERT_TRUE(m);
+    EXPECT_EQ(m->where.offset, 7u);
+    EXPECT_EQ(m->where.line, 2u);
+    EXPECT_EQ(m->where.column, 1u);
+    EXPECT_EQ(m->length, 7u);
+
+    auto all = s.find_all("#pragma");
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[1].where.line, 3u);
+    EXPECT_EQ(all[1].where.column, 3u);
+
+    EXPECT_FALSE(s.find("#pragma", all[1].where.offset + 1));
+    EXPECT_FALSE(s.find("not there"));
+    EXPECT_THROW(s.find(""), std::invalid_argument);
+    EXPECT_EQ(s.position(), 0u); // searching does not move the reader
+}
+
+TEST(Search, NeedleMatchesModelAcrossBlockBoundaries)
+{
+    std::mt19937 rng(7);
+    std::string text;
+    for (int i = 0; i < 5000; ++i)
+        text += "abc\n"[rng() % 4];
+    auto path = write_file("search-random.txt", text);
+    source s(path.c_str());
+
+    for (std::string needle : {"a", "ab", "abca", "cab", "c\na", "aaaa", "abcabcabcabcabcabc"})
+    {
+        auto expected = model(text, {needle});
+        auto found = s.find_all(needle);
+        ASSERT_EQ(found.size(), expected.size()) << needle;
+        for (std::size_t i = 0; i < found.size(); ++i)
+            ASSERT_EQ(found[i].where.offset, expected[i].first) << needle;
+    }
+}
+
+TEST(Search, PatternSetIsLeftmostLongest)
+{
+    auto path = write_file("search-set.txt", "he said she sells his shells");
+    source s(path.c_str());
+    pattern_set keywords{"he", "she", "his", "hers", "shells"};
+
+    auto found = s.find_all(keywords);
+    std::vector<std::string> words;
+    for (const auto &m : found)
+        words.emplace_back(keywords.pattern(m.pattern));
+    EXPECT_EQ(words, (std::vector<std::string>{"he", "she", "his", "shells"}));
+    EXPECT_EQ(found[3].where.offset, 22u);
+    EXPECT_EQ(found[3].length, 6u);
+
+    EXPECT_THROW(pattern_set({"a", ""}), std::invalid_argument);
+}
+
+TEST(Search, PatternSetMatchesModel)
+{
+    std::mt19937 rng(11);
+    std::string text;
+    for (int i = 0; i < 20000; ++i)
+        text += "abcd .\n"[rng() % 7];
+
+    std::vector<std::vector<std::string>> sets = {
+        {"ab", "abc", "bcd", "c"},              // shared prefixes and suffixes
+        {".a", "d.", "abcd", "b", "ab", "ab"},  // more first bytes than the skip scan handles
+        {"aaa", "aa"},                          // overlapping repeats
+        {"zz"}};                                // never matches
+    for (const auto &patterns : sets)
+    {
+        pattern_set set(patterns);
+        auto expected = model(text, patterns);
+        std::size_t length = 0, pattern = 0, from = 0;
+        for (const auto &e : expected)
+        {
+            std::size_t at = set.find(text, from, length, pattern);
+            ASSERT_EQ(at, e.first);
+            ASSERT_EQ(pattern, e.second);
+            from = at + length;
+        }
+        EXPECT_EQ(set.find(text, from, length, pattern), std::string_view::npos);
+    }
+}
+
+TEST(Search, SeekNextAdvancesReader)
+{
+    auto path = write_file("search-seek.txt", ".text\r\nnop\r\n.section data\r\n.section bss\r\n");
+    source s(path.c_str());
+    pattern_set directives{".section", ".text"};
+
+    ASSERT_TRUE(s.seek_next(directives));
+    EXPECT_EQ(s.position(), 0u);
+
+    std::string word;
+    s >> word;
+    ASSERT_TRUE(s.seek_next(".section"));
+    EXPECT_EQ(s.line(), 3);
+    EXPECT_EQ(s.column(), 1);
+    s >> word >> word;
+    EXPECT_EQ(word, "data");
+
+    ASSERT_TRUE(s.seek_next(directives));
+    EXPECT_EQ(s.line(), 4);
+    s.get();
+    EXPECT_FALSE(s.seek_next(directives));
+    EXPECT_EQ(s.line(), 4);
+    EXPECT_EQ(s.column(), 2);
+}
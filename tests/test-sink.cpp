@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+namespace fs = std::filesystem;
+using mms::sink;
+
+extern fs::path exeDir;
+
+// Helper: read file as string
+static std::string read_file(const fs::path &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+TEST(Sink, FormattedOutputAndTrimOnClose)
+{
+    auto path = exeDir / "data" / "sink.lst";
+    {
+        sink out(path.c_str());
+        out << "start:" << ' ' << 42 << ' ' << -7 << ' ' << 2.5 << '\n';
+        out.write_hex(0xBEEF, 6);
+        out.pad_to_column(10);
+        out << "ld a, b\n";
+        EXPECT_EQ(out.line(), 3);
+        EXPECT_EQ(out.column(), 1);
+    }
+    EXPECT_EQ(read_file(path), "start: 42 -7 2.5\n00BEEF   ld a, b\n");
+}
+
+TEST(Sink, ReserveCommitAndBinaryValues)
+{
+    auto path = exeDir / "data" / "sink.bin";
+    sink out(path.c_str());
+    auto span = out.reserve(16);
+    std::memcpy(span.data(), "abc", 3);
+    out.commit(3);
+    EXPECT_THROW(out.commit(1), std::out_of_range);
+
+    std::uint32_t word = 0x11223344;
+    out.write_value(word);
+    EXPECT_EQ(out.size(), 7u);
+    out.close();
+    out.close(); // idempotent
+    EXPECT_THROW(out.reserve(1), std::logic_error);
+
+    std::string data = read_file(path);
+    ASSERT_EQ(data.size(), 7u);
+    std::uint32_t back;
+    std::memcpy(&back, data.data() + 3, 4);
+    EXPECT_EQ(back, word);
+}
+
+TEST(Sink, GrowsAcrossManyExtents)
+{
+    auto path = exeDir / "data" / "sink_big.lst";
+    std::string expected;
+    {
+        sink out(path.c_str(), mms::line_ending::lf, 4096); // small extents force remapping
+        for (int i = 0; i < 5000; ++i)
+        {
+            out << "line " << i << '\n';
+            expected += "line " + std::to_string(i) + "\n";
+        }
+        std::string big(10000, 'x'); // larger than one extent
+        out << big;
+        expected += big;
+        EXPECT_EQ(out.line(), 5001);
+        EXPECT_EQ(out.column(), 10001);
+        auto b = out.mark();
+        EXPECT_EQ(b.position(), expected.size());
+    }
+    EXPECT_EQ(read_file(path), expected);
+}
+
+TEST(Sink, TracksColumnsLikePostrack)
+{
+    auto path = exeDir / "data" / "sink_cr.lst";
+    sink out(path.c_str(), mms::line_ending::cr);
+    out << "ab\rcd\n";
+    EXPECT_EQ(out.line(), 2);
+    EXPECT_EQ(out.column(), 4); // '\n' is an ordinary character in CR mode
+}
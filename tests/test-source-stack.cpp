@@ -0,0 +1,123 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::source_stack;
+
+// Helper: read everything left, pushing "inc.txt" when '@' is read
+static std::string read_all(source_stack &s, const fs::path &include)
+{
+    std::string out;
+    int ch;
+    while ((ch = s.get()) != EOF)
+    {
+        if (ch == '@')
+            s.push(include.c_str());
+        else
+            out += static_cast<char>(ch);
+    }
+    return out;
+}
+
+TEST(SourceStack, PushReadsIncludedFileThenResumes)
+{
+    auto inc = write_file("stack_inc.txt", "INC");
+    auto main = write_file("stack_main.txt", "ab@cd@e");
+    source_stack s(main.c_str());
+    EXPECT_EQ(read_all(s, inc), "abINCcdINCe");
+    EXPECT_EQ(s.depth(), 1u);
+    EXPECT_FALSE(s);
+}
+
+TEST(SourceStack, IncludeChainReportsPositions)
+{
+    auto inc = write_file("stack_chain_inc.txt", "x\ny");
+    auto main = write_file("stack_chain_main.txt", "line1\n  @rest");
+    source_stack s(main.c_str());
+    while (s.get() != '@')
+        ;
+    s.push(inc.c_str());
+    s.get();
+    s.get();
+    s.get(); // 'y'
+
+    auto chain = s.include_chain();
+    ASSERT_EQ(chain.size(), 2u);
+    EXPECT_EQ(chain[0].path, main.string());
+    EXPECT_EQ(chain[0].line, 2);
+    EXPECT_EQ(chain[0].column, 4);
+    EXPECT_EQ(chain[1].path, inc.string());
+    EXPECT_EQ(chain[1].line, 2);
+    EXPECT_EQ(s.file_name(), inc.string());
+}
+
+TEST(SourceStack, PeekAndPutbackAcrossPop)
+{
+    auto inc = write_file("stack_peek_inc.txt", "I");
+    auto main = write_file("stack_peek_main.txt", "@M");
+    source_stack s(main.c_str());
+    s.get();
+    s.push(inc.c_str());
+    EXPECT_EQ(s.get(), 'I');
+    EXPECT_EQ(s.peek(), 'M'); // looks through the exhausted include
+    EXPECT_EQ(s.depth(), 2u);
+    EXPECT_EQ(s.get(), 'M');
+    EXPECT_EQ(s.depth(), 1u);
+    EXPECT_EQ(s.get(), EOF);
+
+    s.putback(); // 'M'
+    s.putback(); // 'I', back inside the include
+    EXPECT_EQ(s.depth(), 2u);
+    EXPECT_EQ(s.get(), 'I');
+    EXPECT_EQ(s.get(), 'M');
+}
+
+TEST(SourceStack, BookmarkSurvivesPopAndPush)
+{
+    auto inc = write_file("stack_mark_inc.txt", "one two");
+    auto main = write_file("stack_mark_main.txt", "@ three");
+    source_stack s(main.c_str());
+    s.get();
+    s.push(inc.c_str());
+
+    std::string word;
+    s >> word;
+    EXPECT_EQ(word, "one");
+    auto b = s.mark();
+
+    s >> word;
+    EXPECT_EQ(word, "two");
+    s >> word;
+    EXPECT_EQ(word, "three");
+    EXPECT_EQ(s.depth(), 1u);
+
+    s.seek(b);
+    EXPECT_EQ(s.depth(), 2u);
+    EXPECT_EQ(s.file_name(), inc.string());
+    s >> word;
+    EXPECT_EQ(word, "two");
+    s >> word;
+    EXPECT_EQ(word, "three");
+}
+
+TEST(SourceStack, ReleaseInactiveInvalidatesBookmarks)
+{
+    auto inc = write_file("stack_rel_inc.txt", "x");
+    auto main = write_file("stack_rel_main.txt", "@y");
+    source_stack s(main.c_str());
+    s.get();
+    s.push(inc.c_str());
+    auto b = s.mark();
+    EXPECT_EQ(s.get(), 'x');
+    EXPECT_EQ(s.get(), 'y');
+    s.release_inactive();
+    EXPECT_THROW(s.seek(b), std::invalid_argument);
+    EXPECT_THROW(s.pop(), std::logic_error);
+}
@@ -1,6 +1,7 @@
 #include <filesystem>
 #include <string>
 #include <fstream>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -230,6 +231,37 @@ TEST(Source, ExtractCharEOFThrows)
     EXPECT_THROW(s >> c, std::runtime_error);
 }
 
+TEST(Source, OpenAndReadWithoutThrowing)
+{
+    auto missing = source::open("data/this-file-does-not-exist.txt");
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error(), std::errc::no_such_file_or_directory);
+
+    auto path = exeDir / "data" / "nothrow.txt";
+    {
+        std::ofstream out(path);
+        out << " 42 -7 x";
+    }
+    auto opened = source::open(path.c_str());
+    ASSERT_TRUE(opened);
+    source &s = **opened;
+
+    static_assert(noexcept(mms::read_int(s)));
+    EXPECT_EQ(*mms::read_int(s), 42);
+    EXPECT_EQ(*mms::read_int(s), -7);
+
+    mms::result<int> bad = mms::read_int(s);
+    ASSERT_FALSE(bad);
+    EXPECT_EQ(bad.error(), mms::errc::invalid_integer);
+    EXPECT_EQ(bad.error().message(), "Invalid integer input");
+    EXPECT_EQ(bad.value_or(0), 0);
+
+    EXPECT_EQ(*mms::read_char(s), 'x');
+    mms::result<char> eof = mms::read_char(s);
+    ASSERT_FALSE(eof);
+    EXPECT_EQ(eof.error(), mms::errc::unexpected_eof);
+}
+
 TEST(Source, OperatorExtractsString)
 {
     auto path = data_file("test-plain-text.txt");
@@ -358,4 +390,202 @@ TEST(Source, MultiplePutbacksAndBookmarkCombined)
 
     EXPECT_EQ(b_val, 73);
     EXPECT_EQ(b_val2, 73);
-}
\ No newline at end of file
+}
+TEST(Source, DetectsCrlfAndExcludesCarriageReturnFromColumns)
+{
+    auto path = exeDir / "data" / "crlf.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "ab\r\ncd\r\n";
+    }
+
+    source s(path.c_str());
+    EXPECT_EQ(s.endings(), mms::line_ending::crlf);
+
+    s.get();
+    s.get();
+    s.get(); // '\r'
+    EXPECT_EQ(s.column(), 3);
+    s.get(); // '\n'
+    EXPECT_EQ(s.line(), 2);
+    EXPECT_EQ(s.column(), 1);
+
+    s.putback();
+    EXPECT_EQ(s.line(), 1);
+    EXPECT_EQ(s.column(), 3);
+
+    s.seek(std::size_t{5});
+    EXPECT_EQ(s.line(), 2);
+    EXPECT_EQ(s.column(), 2);
+}
+
+TEST(Source, ClassicMacLineEndings)
+{
+    auto path = exeDir / "data" / "cr.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "one\rtwo\rthree";
+    }
+
+    source s(path.c_str());
+    EXPECT_EQ(s.endings(), mms::line_ending::cr);
+
+    std::string w;
+    s >> w >> w >> w;
+    EXPECT_EQ(w, "three");
+    EXPECT_EQ(s.line(), 3);
+    EXPECT_EQ(s.column(), 6);
+}
+
+TEST(Source, ExplicitPolicyOverridesDetection)
+{
+    auto path = exeDir / "data" / "cr.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "one\rtwo";
+    }
+
+    source s(path.c_str(), mms::line_ending::lf);
+    while (s.get() != EOF)
+    {
+    }
+    EXPECT_EQ(s.line(), 1);
+}
+
+TEST(Source, CodePointColumns)
+{
+    auto path = exeDir / "data" / "utf8-columns.txt";
+    std::string line;
+    for (int i = 0; i < 2000; ++i)
+        line += "\xCE\xBB "; // "λ "
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "\xC3\xBC" "ber x\n" << line << "end\n";
+    }
+
+    source s(path.c_str());
+    s.set_column_unit(mms::column_unit::code_points, 256);
+    std::string w;
+    s >> w;
+    EXPECT_EQ(w, "\xC3\xBC" "ber");
+    EXPECT_EQ(s.column(), 5);
+    s.putback();
+    EXPECT_EQ(s.column(), 4);
+
+    // Seeking past unread text resolves the column through the index
+    std::size_t end = 8 + line.size();
+    s.seek(end);
+    EXPECT_EQ(s.line(), 2);
+    EXPECT_EQ(s.column(), 4001);
+    s >> w;
+    EXPECT_EQ(w, "end");
+
+    auto m = s.find("end");
+    ASSERT_TRUE(m);
+    EXPECT_EQ(m->where.column, 4001u);
+
+    // Switching back to bytes recomputes the current column
+    s.seek(std::size_t{3});
+    s.set_column_unit(mms::column_unit::bytes);
+    EXPECT_EQ(s.column(), 4);
+    EXPECT_EQ(s.find("end")->where.column, 6001u);
+}
+
+TEST(Source, SplicingSkipsLineContinuations)
+{
+    auto path = exeDir / "data" / "splice.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "#define MAX(a, b) \\\n  ((a) > (b) ? \\\n(a) : (b))\nin\\\nt x;\n";
+    }
+
+    source s(path.c_str());
+    s.set_splicing(true);
+    std::string logical;
+    std::vector<std::pair<int, int>> after; // physical line and column after each character
+    for (int ch; (ch = s.get()) != EOF;)
+    {
+        logical += static_cast<char>(ch);
+        after.emplace_back(s.line(), s.column());
+    }
+    EXPECT_EQ(logical, "#define MAX(a, b)   ((a) > (b) ? (a) : (b))\nint x;\n");
+    EXPECT_EQ(after[logical.find("int") + 1], std::make_pair(4, 3));
+    EXPECT_EQ(after[logical.find("int") + 2], std::make_pair(5, 2)); // the 't' sits on physical line 5
+
+    // Logical and physical offsets map both ways
+    std::size_t t = logical.find("int") + 2;
+    EXPECT_EQ(s.physical_offset(t), std::string_view(s.data(), s.size()).find("t x;"));
+    EXPECT_EQ(s.logical_offset(s.physical_offset(t)), t);
+    auto loc = s.physical_location(logical.find("(a) :"));
+    EXPECT_EQ(loc.line, 3u);
+    EXPECT_EQ(loc.column, 1u);
+    EXPECT_EQ(s.logical_offset(18), s.logical_offset(20)); // inside a continuation
+}
+
+TEST(Source, SplicingWithExtractionAndPutback)
+{
+    auto path = exeDir / "data" / "splice-words.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "\\\nal\\\r\n\\\r\npha be\\\r\nta\r\n";
+    }
+
+    source s(path.c_str());
+    EXPECT_EQ(s.endings(), mms::line_ending::crlf);
+    s.set_splicing(true);
+    EXPECT_EQ(s.peek(), 'a');
+
+    std::string w;
+    s >> w;
+    EXPECT_EQ(w, "alpha");
+    EXPECT_EQ(s.line(), 4);
+    s >> w;
+    EXPECT_EQ(w, "beta");
+    EXPECT_EQ(s.line(), 5);
+    EXPECT_EQ(s.column(), 3);
+
+    // Putting back across a continuation returns to the character before it
+    s.putback();
+    s.putback();
+    EXPECT_EQ(s.line(), 5);
+    EXPECT_EQ(s.column(), 1);
+    s.putback();
+    EXPECT_EQ(s.line(), 4);
+    EXPECT_EQ(s.column(), 6);
+    EXPECT_EQ(s.get(), 'e');
+    EXPECT_EQ(s.get(), 't');
+
+    // Seeking back re-finds continuations from the new position
+    s.seek(std::size_t{0});
+    s >> w;
+    EXPECT_EQ(w, "alpha");
+
+    s.set_splicing(false);
+    s.seek(std::size_t{0});
+    EXPECT_EQ(s.get(), '\\');
+}
+
+TEST(Source, SplicingAcrossTranscodedChunks)
+{
+    // UTF-16 input is converted in chunks; continuations straddle some chunk ends
+    std::string text;
+    for (int i = 0; i < 30000; ++i)
+        text += i % 7 ? "x\\\n" : "xy\\\n";
+    std::string utf16;
+    for (char c : text)
+        utf16 += std::string{c, '\0'};
+
+    auto path = exeDir / "data" / "splice-utf16.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "\xFF\xFE" << utf16;
+    }
+
+    source s(path.c_str());
+    s.set_splicing(true);
+    std::size_t letters = 0;
+    for (int ch; (ch = s.get()) != EOF;)
+        letters += ch == 'x' || ch == 'y';
+    EXPECT_EQ(letters, 30000u + 30000u / 7 + 1);
+    EXPECT_EQ(s.line(), 30001);
+}
@@ -0,0 +1,136 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::source;
+
+TEST(Stats, SeekByOffsetResolvesLineAndColumn)
+{
+    auto path = write_file("stats.txt", "abc\ndef\nghi\njkl");
+    source s(path.c_str());
+
+    // Read the first two lines, then seek inside them (rescan)
+    for (int i = 0; i < 8; ++i)
+        s.get();
+    s.seek(std::size_t{5});
+    EXPECT_EQ(s.line(), 2);
+    EXPECT_EQ(s.column(), 2);
+    EXPECT_EQ(s.get(), 'e');
+
+    // Seek beyond what was read (index)
+    s.seek(std::size_t{13});
+    EXPECT_EQ(s.line(), 4);
+    EXPECT_EQ(s.column(), 2);
+    EXPECT_EQ(s.get(), 'k');
+
+    // Putback across a newline after skipping unread text
+    s.seek(std::size_t{12});
+    s.putback();
+    EXPECT_EQ(s.line(), 3);
+    EXPECT_EQ(s.column(), 4);
+}
+
+TEST(Stats, CountersFollowBuildOption)
+{
+    auto path = write_file("stats.txt", "abc\ndef\nghi\njkl");
+    source s(path.c_str());
+
+    s.peek();
+    s.get();
+    s.get();
+    s.putback();
+    auto b = s.mark();
+    s.seek(b);
+    s.seek(std::size_t{1});  // rescan
+    s.seek(std::size_t{14}); // index
+
+    auto st = s.stats();
+    if constexpr (mms::stats_enabled)
+    {
+        EXPECT_EQ(st.peeks, 1);
+        EXPECT_EQ(st.gets, 2);
+        EXPECT_EQ(st.putbacks, 1);
+        EXPECT_EQ(st.seeks_bookmark, 1);
+        EXPECT_EQ(st.seeks_rescan, 1);
+        EXPECT_EQ(st.seeks_index, 1);
+        EXPECT_EQ(st.index_builds, 1);
+        EXPECT_EQ(st.index_lines, 4);
+        EXPECT_EQ(st.mapped_bytes, s.size());
+        EXPECT_LE(st.resident_bytes, st.mapped_bytes);
+    }
+    else
+    {
+        EXPECT_EQ(st.gets, 0);
+        EXPECT_EQ(st.seeks_index, 0);
+        EXPECT_EQ(st.mapped_bytes, 0);
+    }
+}
+
+TEST(Stats, GlobalAggregateCollectsDestroyedSources)
+{
+    auto path = write_file("stats.txt", "xyz");
+    auto before = mms::global_stats();
+    {
+        source s(path.c_str());
+        while (s.get() != EOF)
+        {
+        }
+    }
+    auto after = mms::global_stats();
+
+    if constexpr (mms::stats_enabled)
+        EXPECT_EQ(after.gets - before.gets, 4); // three characters plus EOF
+    else
+        EXPECT_EQ(after.gets, 0);
+}
+
+TEST(Stats, IndexBuildsAreAddedOnce)
+{
+    std::string text;
+    for (int i = 0; i < 10000; ++i)
+        text += "line " + std::to_string(i) + "\n";
+    auto path = write_file("stats.txt", text);
+
+    auto before = mms::global_stats();
+    mms::source_stats during;
+    {
+        source indexed(path.c_str());
+        indexed.index();
+        source digested(path.c_str());
+        digested.content_digest(); // builds the index in the same pass
+        during = mms::global_stats();
+    }
+    auto after = mms::global_stats();
+
+    if constexpr (mms::stats_enabled)
+    {
+        EXPECT_EQ(during.index_builds - before.index_builds, 2);
+        EXPECT_EQ(during.index_lines - before.index_lines, 2 * 10001);
+        EXPECT_GT(during.index_build_ns, before.index_build_ns);
+        EXPECT_EQ(after.index_builds, during.index_builds);
+        EXPECT_EQ(after.index_lines, during.index_lines);
+    }
+    else
+    {
+        EXPECT_EQ(after.index_builds, 0);
+    }
+}
+
+TEST(Stats, ResidentBytesOfTouchedMapping)
+{
+    auto path = write_file("stats.txt", std::string(8192, 'x'));
+    source s(path.c_str());
+    while (s.get() != EOF)
+    {
+    }
+
+    EXPECT_EQ(mms::resident_bytes(s.data(), s.size()), s.size());
+    EXPECT_EQ(mms::resident_bytes(nullptr, 0), 0);
+}
@@ -0,0 +1,199 @@
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::cursor;
+using mms::mapped_source;
+using mms::token;
+
+// Splits on whitespace, but returns each of "(),;" as its own token
+struct punct_rules : mms::word_rules
+{
+    static bool is_punct(char c) { return c == '(' || c == ')' || c == ',' || c == ';'; }
+
+    std::size_t match(std::string_view rest) const
+    {
+        if (is_punct(rest[0]))
+            return 1;
+        std::size_t n = 0;
+        while (n < rest.size() && !std::isspace(static_cast<unsigned char>(rest[n])) && !is_punct(rest[n]))
+            ++n;
+        return n;
+    }
+};
+
+TEST(Tokenize, SplitsWordsLikeExtractionOperator)
+{
+    std::vector<std::string> words;
+    for (const token &t : mms::tokenize("  Hello,  this\n is\tit  "))
+        words.emplace_back(t.text);
+
+    ASSERT_EQ(words.size(), 4);
+    EXPECT_EQ(words[0], "Hello,");
+    EXPECT_EQ(words[1], "this");
+    EXPECT_EQ(words[2], "is");
+    EXPECT_EQ(words[3], "it");
+}
+
+TEST(Tokenize, ReportsLocations)
+{
+    std::vector<token> toks;
+    for (const token &t : mms::tokenize("ab cd\n  ef\n\ngh"))
+        toks.push_back(t);
+
+    ASSERT_EQ(toks.size(), 4);
+    EXPECT_EQ(toks[0].where.line, 1);
+    EXPECT_EQ(toks[0].where.column, 1);
+    EXPECT_EQ(toks[1].where.column, 4);
+    EXPECT_EQ(toks[2].where.line, 2);
+    EXPECT_EQ(toks[2].where.column, 3);
+    EXPECT_EQ(toks[2].where.offset, 8);
+    EXPECT_EQ(toks[3].where.line, 4);
+    EXPECT_EQ(toks[3].where.column, 1);
+}
+
+TEST(Tokenize, ReportsLocationsForCrAndCrlf)
+{
+    for (auto [text, endings] : {std::pair{"ab cd\r\n  ef\r\n\r\ngh", mms::line_ending::crlf},
+                                 std::pair{"ab cd\r  ef\r\rgh", mms::line_ending::cr}})
+    {
+        std::vector<token> toks;
+        for (const token &t : mms::tokenize(text, {}, mms::word_rules{}, endings))
+            toks.push_back(t);
+
+        ASSERT_EQ(toks.size(), 4);
+        EXPECT_EQ(toks[1].where.line, 1);
+        EXPECT_EQ(toks[1].where.column, 4);
+        EXPECT_EQ(toks[2].where.line, 2);
+        EXPECT_EQ(toks[2].where.column, 3);
+        EXPECT_EQ(toks[3].where.line, 4);
+        EXPECT_EQ(toks[3].where.column, 1);
+    }
+}
+
+TEST(Tokenize, CrOfCrlfTakesNoColumn)
+{
+    // A token ending in '\r' leaves the location on the '\n' of the pair
+    auto loc = mms::advance_location({}, "ab\r", mms::line_ending::crlf);
+    EXPECT_EQ(loc.column, 3);
+    EXPECT_EQ(loc.offset, 3);
+    loc = mms::advance_location(loc, "\ncd", mms::line_ending::crlf);
+    EXPECT_EQ(loc.line, 2);
+    EXPECT_EQ(loc.column, 3);
+}
+
+TEST(Tokenize, PluggableRules)
+{
+    std::vector<std::string> words;
+    for (const token &t : mms::tokenize("f(a,b);", {}, punct_rules{}))
+        words.emplace_back(t.text);
+
+    std::vector<std::string> expected = {"f", "(", "a", ",", "b", ")", ";"};
+    EXPECT_EQ(words, expected);
+}
+
+TEST(Tokenize, ComposesWithRangesViews)
+{
+    auto lengths = mms::tokenize("one two three four") | std::views::transform([](const token &t)
+                                               { return t.text.size(); }) |
+                   std::views::take(3);
+
+    std::vector<std::size_t> out;
+    for (auto n : lengths)
+        out.push_back(n);
+
+    EXPECT_EQ(out, (std::vector<std::size_t>{3, 3, 5}));
+}
+
+TEST(Tokenize, StartsAtCursorPosition)
+{
+    auto path = write_file("tokenize.txt", "skip me\nkeep this");
+    mapped_source ms(path.c_str());
+    cursor c(ms);
+    std::string w;
+    c >> w >> w;
+
+    std::vector<token> toks;
+    for (const token &t : mms::tokenize(c))
+        toks.push_back(t);
+
+    ASSERT_EQ(toks.size(), 2);
+    EXPECT_EQ(toks[0].text, "keep");
+    EXPECT_EQ(toks[0].where.line, 2);
+    EXPECT_EQ(toks[0].where.column, 1);
+    EXPECT_EQ(toks[1].where.offset, 13);
+}
+
+TEST(TokenPipeline, DeliversAllTokensInOrder)
+{
+    std::string text;
+    for (int i = 0; i < 10000; ++i)
+        text += "t" + std::to_string(i) + (i % 7 == 6 ? "\n" : " ");
+
+    mms::token_pipeline pipe(text, 64, 3);
+
+    std::vector<token> batch;
+    int count = 0;
+    bool in_order = true;
+    while (pipe.next(batch))
+    {
+        EXPECT_LE(batch.size(), 64);
+        for (const token &t : batch)
+            in_order &= (t.text == "t" + std::to_string(count++));
+    }
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(count, 10000);
+}
+
+TEST(TokenPipeline, RethrowsTokenizerException)
+{
+    // Throws on the first word starting with '!'
+    struct throwing_rules : mms::word_rules
+    {
+        std::size_t match(std::string_view rest) const
+        {
+            if (rest[0] == '!')
+                throw std::runtime_error("bad token");
+            return mms::word_rules::match(rest);
+        }
+    };
+
+    mms::token_pipeline pipe("a b c d e !f g", 2, 2, throwing_rules{});
+    std::vector<token> batch;
+    std::size_t count = 0;
+    EXPECT_THROW(
+        {
+            while (pipe.next(batch))
+                count += batch.size();
+        },
+        std::runtime_error);
+    EXPECT_EQ(count, 5);
+    EXPECT_FALSE(pipe.next(batch));
+}
+
+TEST(TokenPipeline, EarlyDestructionStopsProducer)
+{
+    std::string text(100000, 'x');
+    for (std::size_t i = 1; i < text.size(); i += 2)
+        text[i] = ' ';
+
+    std::vector<token> batch;
+    {
+        mms::token_pipeline pipe(text, 16, 2);
+        ASSERT_TRUE(pipe.next(batch));
+        EXPECT_EQ(batch.size(), 16);
+    } // must not hang
+    SUCCEED();
+}
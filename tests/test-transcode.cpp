@@ -0,0 +1,173 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mms/mms.h>
+
+#include "test-util.h"
+
+namespace fs = std::filesystem;
+using mms::encoding;
+using mms::source;
+
+// Helper: encode a UTF-8 string (BMP and supplementary) as UTF-16
+static std::string to_utf16(const std::u32string &text, bool big_endian, bool bom)
+{
+    std::string out;
+    auto put = [&](char16_t u)
+    {
+        char hi = static_cast<char>(u >> 8), lo = static_cast<char>(u & 0xFF);
+        out += big_endian ? hi : lo;
+        out += big_endian ? lo : hi;
+    };
+    if (bom)
+        put(0xFEFF);
+    for (char32_t cp : text)
+    {
+        if (cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            put(static_cast<char16_t>(0xD800 + (cp >> 10)));
+            put(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+        }
+        else
+        {
+            put(static_cast<char16_t>(cp));
+        }
+    }
+    return out;
+}
+
+// Helper: read the whole source through get()
+static std::string read_all(source &s)
+{
+    std::string out;
+    int ch;
+    while ((ch = s.get()) != EOF)
+        out += static_cast<char>(ch);
+    return out;
+}
+
+TEST(Transcode, DetectsByteOrderMarks)
+{
+    std::size_t bom = 99;
+    EXPECT_EQ(mms::detect_encoding("\xEF\xBB\xBFx", 4, bom), encoding::utf8);
+    EXPECT_EQ(bom, 3);
+    EXPECT_EQ(mms::detect_encoding("\xFF\xFEx\0", 4, bom), encoding::utf16le);
+    EXPECT_EQ(bom, 2);
+    EXPECT_EQ(mms::detect_encoding("\xFE\xFF\0x", 4, bom), encoding::utf16be);
+    EXPECT_EQ(bom, 2);
+    EXPECT_EQ(mms::detect_encoding("plain", 5, bom), encoding::utf8);
+    EXPECT_EQ(bom, 0);
+}
+
+TEST(Transcode, Utf16LittleAndBigEndian)
+{
+    std::u32string text = U"Hello, €uro \U00010348!";
+    std::string expected = "Hello, \xE2\x82\xAC" "uro \xF0\x90\x8D\x88!";
+
+    for (bool be : {false, true})
+    {
+        std::string in = to_utf16(text, be, false);
+        std::string out(mms::utf8_capacity(encoding::utf16le, in.size()), '\0');
+        std::size_t consumed = 0;
+        std::size_t n = mms::transcode_to_utf8(be ? encoding::utf16be : encoding::utf16le,
+                                               in.data(), in.size(), out.data(), true, consumed);
+        out.resize(n);
+        EXPECT_EQ(consumed, in.size());
+        EXPECT_EQ(out, expected);
+    }
+}
+
+TEST(Transcode, SplitSurrogatePairIsLeftForNextBlock)
+{
+    std::string in = to_utf16(U"a\U00010348", false, false);
+    std::string out(16, '\0');
+    std::size_t consumed = 0;
+
+    // Stop between the two halves of the pair
+    std::size_t n = mms::transcode_to_utf8(encoding::utf16le, in.data(), 4, out.data(), false, consumed);
+    EXPECT_EQ(n, 1);
+    EXPECT_EQ(consumed, 2);
+}
+
+TEST(Transcode, Latin1)
+{
+    std::string in = "caf\xE9 na\xEFve, long enough to use the block path";
+    std::string out(mms::utf8_capacity(encoding::latin1, in.size()), '\0');
+    std::size_t consumed = 0;
+    out.resize(mms::transcode_to_utf8(encoding::latin1, in.data(), in.size(), out.data(), true, consumed));
+
+    EXPECT_EQ(out, "caf\xC3\xA9 na\xC3\xAFve, long enough to use the block path");
+}
+
+TEST(Transcode, SourceReadsUtf16WithBom)
+{
+    std::u32string text;
+    for (int i = 0; i < 20000; ++i)
+        text += (i % 50 == 49) ? U"\r\n" : (i % 13 == 0 ? U"é" : U"x");
+    auto path = write_file("utf16.txt", to_utf16(text, false, true));
+
+    source s(path.c_str());
+    EXPECT_EQ(s.input_encoding(), encoding::utf16le);
+    EXPECT_EQ(s.endings(), mms::line_ending::crlf);
+
+    std::string content = read_all(s);
+    EXPECT_EQ(content.size(), s.size());
+    EXPECT_EQ(std::string(s.data(), s.size()), content);
+    EXPECT_EQ(content.substr(0, 3), "\xC3\xA9x");
+    EXPECT_EQ(s.line(), 20000 / 50 + 1);
+}
+
+TEST(Transcode, SourceReadsUtf16BigEndianWords)
+{
+    auto path = write_file("utf16be.txt", to_utf16(U"alpha  beta\ngamma", true, true));
+
+    source s(path.c_str());
+    std::string a, b, c;
+    s >> a >> b >> c;
+
+    EXPECT_EQ(a, "alpha");
+    EXPECT_EQ(b, "beta");
+    EXPECT_EQ(c, "gamma");
+    EXPECT_EQ(s.line(), 2);
+}
+
+TEST(Transcode, ExplicitLatin1)
+{
+    auto path = write_file("latin1.txt", "na\xEFve");
+    source s(path.c_str(), mms::line_ending::detect, encoding::latin1);
+
+    EXPECT_EQ(read_all(s), "na\xC3\xAFve");
+}
+
+TEST(Transcode, Utf8BomIsSkippedWithoutCopy)
+{
+    auto path = write_file("utf8bom.txt", "\xEF\xBB\xBFword");
+    source s(path.c_str());
+
+    EXPECT_EQ(s.input_encoding(), encoding::utf8);
+    EXPECT_EQ(s.size(), 4);
+    std::string w;
+    s >> w;
+    EXPECT_EQ(w, "word");
+    EXPECT_EQ(s.column(), 5);
+}
+
+TEST(Transcode, PeekAcrossChunksMatchesGet)
+{
+    std::u32string text(100000, U'q');
+    auto path = write_file("utf16big.txt", to_utf16(text, false, true));
+
+    source s(path.c_str());
+    std::size_t n = 0;
+    while (s)
+    {
+        int p = s.peek();
+        EXPECT_EQ(p, s.get());
+        ++n;
+    }
+    EXPECT_EQ(n, 100000);
+}
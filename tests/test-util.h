@@ -0,0 +1,23 @@
+/// \file
+/// \brief Helpers shared by the test files.
+///
+/// Copyright (c) 2024–2025 Tomaz Stih
+/// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+/// Directory of the test executable, set by main.cpp
+extern std::filesystem::path exeDir;
+
+/// \brief Write \p content to bin/data/\p name.
+/// \return Path of the file
+inline std::filesystem::path write_file(const std::string &name, const std::string &content)
+{
+    auto path = exeDir / "data" / name;
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+    return path;
+}